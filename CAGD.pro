@@ -2,8 +2,43 @@ SOURCES += src/visualization/main.cpp \
            src/test_main.cpp \
     src/visualization/beziereditor.cpp
 HEADERS += src/geometry/bezier/deCasteljau.h \
+    src/geometry/bezier/lanes.h \
+    src/geometry/bezier/pointTraits.h \
+    src/geometry/bezier/controlPolygonSoA.h \
+    src/geometry/bezier/fixedDegree.h \
+    src/geometry/bezier/hornerEvaluator.h \
+    src/geometry/bezier/forwardDifferencing.h \
+    src/geometry/bezier/adaptiveTessellation.h \
+    src/geometry/bezier/parallelBatch.h \
+    src/geometry/bezier/compensatedDeCasteljau.h \
+    src/geometry/bezier/blossomEvaluator.h \
+    src/geometry/bezier/cachedSampleCurve.h \
+    src/geometry/bezier/bezierCurve.h \
+    src/geometry/bezier/stridedView.h \
+    src/geometry/bezier/boundingBox.h \
+    src/geometry/bezier/curveBVH.h \
+    src/geometry/bezier/intersection.h \
+    src/geometry/bezier/projection.h \
+    src/geometry/bezier/arcLength.h \
+    src/geometry/bezier/instrumentation.h \
+    src/geometry/bezier/degreeElevation.h \
+    src/geometry/bezier/rational.h \
+    src/geometry/bezier/bezierPatch.h \
+    src/geometry/bezier/tessellationCache.h \
+    src/concurrency/workStealingPool.h \
+    src/concurrency/spscQueue.h \
+    src/concurrency/coalescingPipeline.h \
+    src/io/curveSetFile.h \
+    src/io/curveSetBatch.h \
     src/visualization/beziereditor.h
 TARGET = CAGDVisualization
 
 
 QT += widgets
+CONFIG += c++1z
+
+# Profiling builds of the Bezier hot paths (see instrumentation.h), with
+# `qmake CONFIG+=cagd_instrumentation` or `CONFIG+=cagd_instrumentation_timing`.
+# The macros must be defined for the whole program, never per source file.
+cagd_instrumentation: DEFINES += CAGD_BEZIER_INSTRUMENTATION
+cagd_instrumentation_timing: DEFINES += CAGD_BEZIER_INSTRUMENTATION_TIMING
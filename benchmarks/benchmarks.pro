@@ -0,0 +1,17 @@
+TEMPLATE = app
+TARGET = CAGDBenchmarks
+
+CONFIG += console c++1z thread release
+CONFIG -= app_bundle qt
+
+INCLUDEPATH += ../src
+
+SOURCES += bezierBenchmarks.cpp
+
+LIBS += -lbenchmark
+
+# Profiling builds of the Bezier hot paths (see instrumentation.h), with
+# `qmake CONFIG+=cagd_instrumentation` or `CONFIG+=cagd_instrumentation_timing`.
+# The macros must be defined for the whole program, never per source file.
+cagd_instrumentation: DEFINES += CAGD_BEZIER_INSTRUMENTATION
+cagd_instrumentation_timing: DEFINES += CAGD_BEZIER_INSTRUMENTATION_TIMING
@@ -0,0 +1,899 @@
+#include "geometry/bezier/deCasteljau.h"
+#include "geometry/bezier/controlPolygonSoA.h"
+#include "geometry/bezier/fixedDegree.h"
+#include "geometry/bezier/hornerEvaluator.h"
+#include "geometry/bezier/forwardDifferencing.h"
+#include "geometry/bezier/adaptiveTessellation.h"
+#include "geometry/bezier/parallelBatch.h"
+#include "geometry/bezier/blossomEvaluator.h"
+#include "geometry/bezier/cachedSampleCurve.h"
+#include "geometry/bezier/bezierCurve.h"
+#include "geometry/bezier/boundingBox.h"
+#include "geometry/bezier/curveBVH.h"
+#include "geometry/bezier/intersection.h"
+#include "geometry/bezier/projection.h"
+#include "geometry/bezier/arcLength.h"
+#include "geometry/bezier/degreeElevation.h"
+#include "geometry/bezier/rational.h"
+#include "geometry/bezier/bezierPatch.h"
+#include "geometry/bezier/tessellationCache.h"
+#include "concurrency/spscQueue.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+    Benchmarks for the kernels in Geometry::Bezier.
+
+    Unless noted otherwise, every benchmark is registered for point dimensions
+    2, 3 and 4, float and double coordinates, and degrees 1 to 32 (the last
+    argument of the benchmark's name). Throughput is reported as points per
+    second in `items_per_second`.
+
+    For machine-readable output, run with
+        --benchmark_format=json
+    or
+        --benchmark_out=<file>.json --benchmark_out_format=json
+*/
+
+
+template< int Dim, typename Scalar >
+struct BenchPoint
+{
+    BenchPoint operator+(const BenchPoint &other) const
+    {
+        BenchPoint p;
+        for (int d = 0; d < Dim; ++d)
+            p.x[d] = x[d] + other.x[d];
+        return p;
+    }
+
+    BenchPoint operator-(const BenchPoint &other) const
+    {
+        BenchPoint p;
+        for (int d = 0; d < Dim; ++d)
+            p.x[d] = x[d] - other.x[d];
+        return p;
+    }
+
+    // Not a template, so that the float parameters used by the algorithms
+    // convert to double for double points.
+    friend BenchPoint operator*(Scalar scalar, const BenchPoint &vec)
+    {
+        BenchPoint p;
+        for (int d = 0; d < Dim; ++d)
+            p.x[d] = scalar * vec.x[d];
+        return p;
+    }
+
+    std::array<Scalar, Dim> x;
+};
+
+template< int Dim, typename S >
+struct Geometry::Bezier::PointTraits<BenchPoint<Dim, S>>
+{
+    static constexpr int Dimension = Dim;
+    typedef S Scalar;
+
+    static Scalar coordinate(const BenchPoint<Dim, S> &p, int d)
+    {
+        return p.x[d];
+    }
+};
+
+
+namespace
+{
+
+    template< int Dim, typename Scalar >
+    std::vector<BenchPoint<Dim, Scalar>> randomPolygon(int numPoints, unsigned int seed = 1)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<Scalar> coordinate(-1, 1);
+
+        std::vector<BenchPoint<Dim, Scalar>> points(numPoints);
+        for (auto &p : points)
+            for (int d = 0; d < Dim; ++d)
+                p.x[d] = coordinate(rng);
+
+        return points;
+    }
+
+    std::vector<float> uniformParams(int count)
+    {
+        std::vector<float> params(count);
+        for (int k = 0; k < count; ++k)
+            params[k] = float(k) / (count - 1);
+        return params;
+    }
+
+    constexpr int NumParams = 256;
+
+    void degrees(benchmark::internal::Benchmark *benchmark)
+    {
+        benchmark->ArgName("degree")->DenseRange(1, 32);
+    }
+
+}
+
+
+template< int Dim, typename Scalar >
+static void BM_deCasteljau(benchmark::State &state)
+{
+    auto points = randomPolygon<Dim, Scalar>(state.range(0) + 1);
+    auto params = uniformParams(NumParams);
+
+    for (auto _ : state)
+        for (float t : params)
+            benchmark::DoNotOptimize(Geometry::Bezier::deCasteljau(points, t));
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+template< int Dim, typename Scalar >
+static void BM_deCasteljauWorkspace(benchmark::State &state)
+{
+    auto points = randomPolygon<Dim, Scalar>(state.range(0) + 1);
+    auto params = uniformParams(NumParams);
+    Geometry::Bezier::DeCasteljauWorkspace<BenchPoint<Dim, Scalar>> workspace;
+
+    for (auto _ : state)
+        for (float t : params)
+            benchmark::DoNotOptimize(Geometry::Bezier::deCasteljau(points, t, workspace));
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+template< int Dim, typename Scalar >
+static void BM_deCasteljauBatch(benchmark::State &state)
+{
+    auto points = randomPolygon<Dim, Scalar>(state.range(0) + 1);
+    auto params = uniformParams(NumParams);
+    std::vector<BenchPoint<Dim, Scalar>> out(NumParams);
+
+    for (auto _ : state)
+    {
+        Geometry::Bezier::deCasteljau(points, params.begin(), params.end(), out.begin());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+template< int Dim, typename Scalar >
+static void BM_deCasteljauSoABatch(benchmark::State &state)
+{
+    auto points = randomPolygon<Dim, Scalar>(state.range(0) + 1);
+    auto polygon = Geometry::Bezier::ControlPolygonSoA<Dim, Scalar>::fromPoints(points);
+    auto params = uniformParams(NumParams);
+    std::vector<std::array<Scalar, Dim>> out(NumParams);
+
+    for (auto _ : state)
+    {
+        Geometry::Bezier::deCasteljau(polygon, params.begin(), params.end(), out.begin());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+/*
+    The batched rational evaluation: the SoA batch above on the homogeneous
+    polygon, with one more coordinate array and one division per point.
+*/
+template< int Dim, typename Scalar >
+static void BM_rationalDeCasteljauBatch(benchmark::State &state)
+{
+    auto points = randomPolygon<Dim, Scalar>(state.range(0) + 1);
+    std::vector<Scalar> weights(points.size());
+    for (std::size_t idx = 0; idx < weights.size(); ++idx)
+        weights[idx] = Scalar(0.5) + Scalar(idx % 3) / 2;
+
+    auto polygon = Geometry::Bezier::RationalPolygonSoA<Dim, Scalar>::fromPoints(points, weights);
+    auto params = uniformParams(NumParams);
+    std::vector<std::array<Scalar, Dim>> out(NumParams);
+
+    for (auto _ : state)
+    {
+        Geometry::Bezier::deCasteljau(polygon, params.begin(), params.end(), out.begin());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+template< int Dim, typename Scalar >
+static void BM_blossom(benchmark::State &state)
+{
+    int degree = state.range(0);
+    auto points = randomPolygon<Dim, Scalar>(degree + 1);
+
+    std::vector<std::vector<float>> params;
+    for (float t : uniformParams(NumParams))
+    {
+        std::vector<float> sequence(degree);
+        for (int k = 0; k < degree; ++k)
+            sequence[k] = k % 2 ? t : 1 - t;
+        params.push_back(sequence);
+    }
+
+    for (auto _ : state)
+        for (const auto &sequence : params)
+            benchmark::DoNotOptimize(Geometry::Bezier::blossom(points, sequence));
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+// The queries of a subdivision, {t0...t0}, {t0...t0 t1}, ..., {t1...t1},
+// which share prefixes of decreasing length.
+template< int Dim, typename Scalar >
+static void BM_blossomEvaluator(benchmark::State &state)
+{
+    int degree = state.range(0);
+    auto points = randomPolygon<Dim, Scalar>(degree + 1);
+
+    std::vector<std::vector<float>> params;
+    for (int idx = 0; idx <= degree; ++idx)
+    {
+        std::vector<float> sequence(degree, 0.25f);
+        std::fill(sequence.end() - idx, sequence.end(), 0.75f);
+        params.push_back(sequence);
+    }
+
+    Geometry::Bezier::BlossomEvaluator<BenchPoint<Dim, Scalar>> evaluator(points);
+
+    for (auto _ : state)
+        for (const auto &sequence : params)
+            benchmark::DoNotOptimize(evaluator(sequence));
+
+    state.SetItemsProcessed(state.iterations() * params.size());
+}
+
+template< int Dim, typename Scalar >
+static void BM_subdivideIndex(benchmark::State &state)
+{
+    int numPoints = state.range(0) + 1;
+    auto points = randomPolygon<Dim, Scalar>(numPoints);
+
+    for (auto _ : state)
+        for (int idx = 0; idx < numPoints; ++idx)
+            benchmark::DoNotOptimize(Geometry::Bezier::subdivide(points, idx, 0.25f, 0.75f));
+
+    state.SetItemsProcessed(state.iterations() * numPoints);
+}
+
+template< int Dim, typename Scalar >
+static void BM_subdivide(benchmark::State &state)
+{
+    int numPoints = state.range(0) + 1;
+    auto points = randomPolygon<Dim, Scalar>(numPoints);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Geometry::Bezier::subdivide(points, 0.25f, 0.75f));
+
+    state.SetItemsProcessed(state.iterations() * numPoints);
+}
+
+template< int Dim, typename Scalar >
+static void BM_subdivideWorkspace(benchmark::State &state)
+{
+    int numPoints = state.range(0) + 1;
+    auto points = randomPolygon<Dim, Scalar>(numPoints);
+    Geometry::Bezier::DeCasteljauWorkspace<BenchPoint<Dim, Scalar>> workspace;
+    std::vector<BenchPoint<Dim, Scalar>> out;
+
+    for (auto _ : state)
+    {
+        Geometry::Bezier::subdivide(points, 0.25f, 0.75f, workspace, out);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * numPoints);
+}
+
+// Dragging a control point: every iteration moves one point, in turn, and
+// updates a scheme filled with t = 0.5.
+template< int Dim, typename Scalar >
+static void BM_schemeSetPoint(benchmark::State &state)
+{
+    int numPoints = state.range(0) + 1;
+    auto points = randomPolygon<Dim, Scalar>(numPoints);
+    Geometry::Bezier::DeCasteljauScheme<BenchPoint<Dim, Scalar>> scheme(points);
+    scheme.fill(0.5f);
+
+    int pointIdx = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(scheme.setPoint(pointIdx, points[pointIdx], 0.5f));
+        pointIdx = (pointIdx + 1) % numPoints;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+// The same drag on NumParams cached samples.
+template< int Dim, typename Scalar >
+static void BM_cachedSampleMovePoint(benchmark::State &state)
+{
+    int numPoints = state.range(0) + 1;
+    auto points = randomPolygon<Dim, Scalar>(numPoints);
+    Geometry::Bezier::CachedSampleCurve<BenchPoint<Dim, Scalar>> curve(points, uniformParams(NumParams));
+
+    int pointIdx = 0;
+    for (auto _ : state)
+    {
+        curve.movePoint(pointIdx, points[pointIdx]);
+        benchmark::ClobberMemory();
+        pointIdx = (pointIdx + 1) % numPoints;
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+template< int Dim, typename Scalar >
+static void BM_split(benchmark::State &state)
+{
+    int numPoints = state.range(0) + 1;
+    auto points = randomPolygon<Dim, Scalar>(numPoints);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(Geometry::Bezier::split(points, 0.5f));
+
+    state.SetItemsProcessed(state.iterations() * 2 * numPoints);
+}
+
+template< int Dim, typename Scalar >
+static void BM_boundingBoxCull(benchmark::State &state)
+{
+    const int numCurves = 1024;
+
+    Geometry::Bezier::BoundingBoxCache<Dim, Scalar> cache;
+    for (int c = 0; c < numCurves; ++c)
+        cache.push_back(randomPolygon<Dim, Scalar>(state.range(0) + 1, c + 1));
+
+    Geometry::Bezier::BoundingBox<Dim, Scalar> query;
+    query.lower.fill(Scalar(0.9));
+    query.upper.fill(Scalar(1.1));
+
+    std::vector<int> hits;
+    hits.reserve(numCurves);
+
+    for (auto _ : state)
+    {
+        hits.clear();
+        cache.overlapping(query, std::back_inserter(hits));
+        benchmark::DoNotOptimize(hits.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * numCurves);
+}
+
+template< int Dim, typename Scalar >
+static void BM_bvhClosest(benchmark::State &state)
+{
+    const int numCurves = 1024;
+
+    std::vector<std::vector<BenchPoint<Dim, Scalar>>> curves;
+    for (int c = 0; c < numCurves; ++c)
+        curves.push_back(randomPolygon<Dim, Scalar>(state.range(0) + 1, c + 1));
+
+    Geometry::Bezier::CurveBVH<BenchPoint<Dim, Scalar>> bvh(curves, Scalar(0.01));
+    auto queries = randomPolygon<Dim, Scalar>(NumParams, numCurves + 1);
+
+    for (auto _ : state)
+        for (const auto &q : queries)
+            benchmark::DoNotOptimize(bvh.closest(q));
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+template< int Dim, typename Scalar >
+static void BM_intersect(benchmark::State &state)
+{
+    constexpr int NumPairs = 16;
+
+    std::vector<std::vector<BenchPoint<Dim, Scalar>>> curves;
+    for (int c = 0; c < 2 * NumPairs; ++c)
+        curves.push_back(randomPolygon<Dim, Scalar>(state.range(0) + 1, c + 1));
+
+    Geometry::Bezier::CurveIntersector<BenchPoint<Dim, Scalar>> intersector(Scalar(1e-4));
+    std::vector<Geometry::Bezier::CurveIntersection<float>> found;
+
+    for (auto _ : state)
+    {
+        found.clear();
+        for (int pairIdx = 0; pairIdx < NumPairs; ++pairIdx)
+            intersector(curves[2 * pairIdx], curves[2 * pairIdx + 1], std::back_inserter(found));
+        benchmark::DoNotOptimize(found.data());
+    }
+
+    // Items are intersections found, so items_per_second is intersections per second.
+    state.SetItemsProcessed(state.iterations() * found.size());
+    state.counters["pairs_per_second"] = benchmark::Counter(state.iterations() * NumPairs,
+                                                            benchmark::Counter::kIsRate);
+}
+
+template< int Dim, typename Scalar >
+static void BM_projectBatch(benchmark::State &state)
+{
+    auto points = randomPolygon<Dim, Scalar>(state.range(0) + 1);
+    auto queries = randomPolygon<Dim, Scalar>(NumParams, 2);
+
+    Geometry::Bezier::CurveProjector<BenchPoint<Dim, Scalar>> projector(points);
+    std::vector<Geometry::Bezier::Projection<BenchPoint<Dim, Scalar>, float>> out;
+    out.reserve(NumParams);
+
+    for (auto _ : state)
+    {
+        out.clear();
+        projector.project(queries.begin(), queries.end(), std::back_inserter(out));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+/*
+    The brute-force projection the above replaces: the nearest of 4096 samples,
+    which is still less accurate than a few Newton steps.
+*/
+template< int Dim, typename Scalar >
+static void BM_projectDenseSampling(benchmark::State &state)
+{
+    auto points = randomPolygon<Dim, Scalar>(state.range(0) + 1);
+    auto queries = randomPolygon<Dim, Scalar>(16, 2);
+
+    auto params = uniformParams(4096);
+    std::vector<BenchPoint<Dim, Scalar>> samples;
+    Geometry::Bezier::deCasteljau(points, params.begin(), params.end(), std::back_inserter(samples));
+
+    for (auto _ : state)
+    {
+        for (const auto &q : queries)
+        {
+            Scalar best = std::numeric_limits<Scalar>::infinity();
+            for (const auto &p : samples)
+            {
+                Scalar distanceSquared = 0;
+                for (int d = 0; d < Dim; ++d)
+                    distanceSquared += (p.x[d] - q.x[d]) * (p.x[d] - q.x[d]);
+                best = std::min(best, distanceSquared);
+            }
+            benchmark::DoNotOptimize(best);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+template< int Dim, typename Scalar >
+static void BM_arcLengthParameter(benchmark::State &state)
+{
+    Geometry::Bezier::BezierCurve<BenchPoint<Dim, Scalar>> curve(randomPolygon<Dim, Scalar>(state.range(0) + 1));
+    Geometry::Bezier::ArcLengthTable<BenchPoint<Dim, Scalar>> table(curve);
+
+    auto params = uniformParams(NumParams);
+    for (float &s : params)
+        s *= table.length();
+
+    for (auto _ : state)
+    {
+        for (float s : params)
+            benchmark::DoNotOptimize(table.parameter(s));
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+/*
+    Brings a set of SoA polygons of mixed degrees (1 to 8) to the benchmark's
+    degree, by elevation or least-squares reduction.
+*/
+template< int Dim, typename Scalar >
+static void BM_changeDegree(benchmark::State &state)
+{
+    constexpr int NumPolygons = 256;
+
+    std::vector<Geometry::Bezier::ControlPolygonSoA<Dim, Scalar>> polygons;
+    for (int polygonIdx = 0; polygonIdx < NumPolygons; ++polygonIdx)
+        polygons.push_back(Geometry::Bezier::ControlPolygonSoA<Dim, Scalar>::fromPoints(
+            randomPolygon<Dim, Scalar>(polygonIdx % 8 + 2, polygonIdx + 1)));
+
+    std::vector<Geometry::Bezier::ControlPolygonSoA<Dim, Scalar>> out;
+
+    for (auto _ : state)
+    {
+        Geometry::Bezier::changeDegree(polygons, state.range(0), out);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumPolygons);
+}
+
+/*
+    A 16 x 16 grid on a patch of the benchmark's degree in both directions,
+    through a warmed-up workspace, so nothing is allocated in the loop.
+*/
+template< int Dim, typename Scalar >
+static void BM_tessellatePatchGrid(benchmark::State &state)
+{
+    constexpr int Steps = 16;
+
+    int degree = state.range(0);
+    Geometry::Bezier::BezierPatch<BenchPoint<Dim, Scalar>> patch(
+        degree, degree, randomPolygon<Dim, Scalar>((degree + 1) * (degree + 1)));
+
+    Geometry::Bezier::BezierPatchWorkspace<BenchPoint<Dim, Scalar>> workspace;
+    workspace.reserve(patch);
+    std::vector<BenchPoint<Dim, Scalar>> out((Steps + 1) * (Steps + 1));
+
+    for (auto _ : state)
+    {
+        Geometry::Bezier::tessellateGrid(patch, Steps, Steps, out.begin(), workspace);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * out.size());
+}
+
+template< int Dim, typename Scalar >
+static void BM_curveDerivatives(benchmark::State &state)
+{
+    int degree = state.range(0);
+    Geometry::Bezier::BezierCurve<BenchPoint<Dim, Scalar>> curve(randomPolygon<Dim, Scalar>(degree + 1));
+    auto params = uniformParams(NumParams);
+
+    typedef typename Geometry::Bezier::BezierCurve<BenchPoint<Dim, Scalar>>::Derivatives Derivatives;
+    std::vector<Derivatives> out;
+    out.reserve(NumParams);
+
+    for (auto _ : state)
+    {
+        out.clear();
+        curve.derivatives(params.begin(), params.end(), std::back_inserter(out));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+template< int Dim, typename Scalar >
+static void BM_horner(benchmark::State &state)
+{
+    auto points = randomPolygon<Dim, Scalar>(state.range(0) + 1);
+    auto params = uniformParams(NumParams);
+    Geometry::Bezier::HornerEvaluator<BenchPoint<Dim, Scalar>> evaluator(points);
+
+    for (auto _ : state)
+        for (float t : params)
+            benchmark::DoNotOptimize(evaluator(t));
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+template< int Dim, typename Scalar >
+static void BM_tessellateUniform(benchmark::State &state)
+{
+    auto points = randomPolygon<Dim, Scalar>(state.range(0) + 1);
+    std::vector<BenchPoint<Dim, Scalar>> out(NumParams);
+
+    for (auto _ : state)
+    {
+        Geometry::Bezier::tessellateUniform(points, NumParams - 1, out.begin());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+template< int Dim, typename Scalar >
+static void BM_tessellateAdaptive(benchmark::State &state)
+{
+    auto points = randomPolygon<Dim, Scalar>(state.range(0) + 1);
+    std::vector<BenchPoint<Dim, Scalar>> out;
+
+    std::size_t numOutput = 0;
+    for (auto _ : state)
+    {
+        out.clear();
+        Geometry::Bezier::tessellateAdaptive(points, 1e-3f, std::back_inserter(out));
+        numOutput += out.size();
+    }
+
+    state.SetItemsProcessed(numOutput);
+}
+
+
+#define CAGD_BENCHMARK_ALL(func) \
+    BENCHMARK_TEMPLATE(func, 2, float)->Apply(degrees); \
+    BENCHMARK_TEMPLATE(func, 3, float)->Apply(degrees); \
+    BENCHMARK_TEMPLATE(func, 4, float)->Apply(degrees); \
+    BENCHMARK_TEMPLATE(func, 2, double)->Apply(degrees); \
+    BENCHMARK_TEMPLATE(func, 3, double)->Apply(degrees); \
+    BENCHMARK_TEMPLATE(func, 4, double)->Apply(degrees)
+
+CAGD_BENCHMARK_ALL(BM_deCasteljau);
+CAGD_BENCHMARK_ALL(BM_deCasteljauWorkspace);
+CAGD_BENCHMARK_ALL(BM_deCasteljauBatch);
+CAGD_BENCHMARK_ALL(BM_deCasteljauSoABatch);
+CAGD_BENCHMARK_ALL(BM_rationalDeCasteljauBatch);
+CAGD_BENCHMARK_ALL(BM_blossom);
+CAGD_BENCHMARK_ALL(BM_blossomEvaluator);
+CAGD_BENCHMARK_ALL(BM_subdivideIndex);
+CAGD_BENCHMARK_ALL(BM_subdivide);
+CAGD_BENCHMARK_ALL(BM_subdivideWorkspace);
+CAGD_BENCHMARK_ALL(BM_schemeSetPoint);
+CAGD_BENCHMARK_ALL(BM_cachedSampleMovePoint);
+CAGD_BENCHMARK_ALL(BM_split);
+CAGD_BENCHMARK_ALL(BM_boundingBoxCull);
+CAGD_BENCHMARK_ALL(BM_bvhClosest);
+CAGD_BENCHMARK_ALL(BM_intersect);
+CAGD_BENCHMARK_ALL(BM_projectBatch);
+CAGD_BENCHMARK_ALL(BM_projectDenseSampling);
+CAGD_BENCHMARK_ALL(BM_arcLengthParameter);
+CAGD_BENCHMARK_ALL(BM_changeDegree);
+CAGD_BENCHMARK_ALL(BM_tessellatePatchGrid);
+CAGD_BENCHMARK_ALL(BM_curveDerivatives);
+CAGD_BENCHMARK_ALL(BM_horner);
+CAGD_BENCHMARK_ALL(BM_tessellateUniform);
+CAGD_BENCHMARK_ALL(BM_tessellateAdaptive);
+
+
+/*
+    The fixed-degree kernels take their degree as a template argument, so they
+    are registered at startup for every degree from 1 to 32 instead.
+*/
+
+template< int Degree, int Dim, typename Scalar >
+static void BM_fixedDeCasteljau(benchmark::State &state)
+{
+    auto points = randomPolygon<Dim, Scalar>(Degree + 1);
+    std::array<BenchPoint<Dim, Scalar>, Degree + 1> polygon;
+    std::copy(points.begin(), points.end(), polygon.begin());
+    auto params = uniformParams(NumParams);
+
+    for (auto _ : state)
+        for (float t : params)
+            benchmark::DoNotOptimize(Geometry::Bezier::deCasteljau<Degree>(polygon, t));
+
+    state.SetItemsProcessed(state.iterations() * NumParams);
+}
+
+template< int Dim, typename Scalar, int... DegreesMinusOne >
+static void registerFixedDegree(const std::string &typeName, std::integer_sequence<int, DegreesMinusOne...>)
+{
+    (benchmark::RegisterBenchmark(("BM_fixedDeCasteljau<" + std::to_string(Dim) + ", " + typeName
+                                   + ">/degree:" + std::to_string(DegreesMinusOne + 1)).c_str(),
+                                  BM_fixedDeCasteljau<DegreesMinusOne + 1, Dim, Scalar>), ...);
+}
+
+static void registerFixedDegreeBenchmarks()
+{
+    auto degrees = std::make_integer_sequence<int, 32>();
+
+    registerFixedDegree<2, float>("float", degrees);
+    registerFixedDegree<3, float>("float", degrees);
+    registerFixedDegree<4, float>("float", degrees);
+    registerFixedDegree<2, double>("double", degrees);
+    registerFixedDegree<3, double>("double", degrees);
+    registerFixedDegree<4, double>("double", degrees);
+}
+
+
+/*
+    Thread scaling of the parallel batch API: cubic 3D float curves, evaluated
+    at 16 parameters each, on pools of 1 to 64 threads.
+*/
+
+static void BM_deCasteljauBatchParallel(benchmark::State &state)
+{
+    constexpr int NumPolygons = 1 << 14;
+
+    std::vector<std::vector<BenchPoint<3, float>>> polygons;
+    for (int c = 0; c < NumPolygons; ++c)
+        polygons.push_back(randomPolygon<3, float>(4, c + 1));
+
+    auto params = uniformParams(16);
+    std::vector<BenchPoint<3, float>> out(NumPolygons * params.size());
+
+    Concurrency::WorkStealingPool pool(state.range(0));
+
+    for (auto _ : state)
+    {
+        Geometry::Bezier::deCasteljauBatch(pool, polygons, params, out.begin());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * out.size());
+}
+
+BENCHMARK(BM_deCasteljauBatchParallel)->ArgName("threads")->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+
+static void BM_subdivideBatchParallel(benchmark::State &state)
+{
+    constexpr int NumPolygons = 1 << 14;
+
+    std::vector<std::vector<BenchPoint<3, float>>> polygons;
+    for (int c = 0; c < NumPolygons; ++c)
+        polygons.push_back(randomPolygon<3, float>(4, c + 1));
+
+    std::vector<BenchPoint<3, float>> out(NumPolygons * 4);
+
+    Concurrency::WorkStealingPool pool(state.range(0));
+
+    for (auto _ : state)
+    {
+        Geometry::Bezier::subdivideBatch(pool, polygons, 0.25f, 0.75f, out.begin());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * out.size());
+}
+
+BENCHMARK(BM_subdivideBatchParallel)->ArgName("threads")->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+
+
+/*
+    All-pairs intersection of 4096 random planar cubics scattered over a
+    square, on pools of 1 to 64 threads. Items are intersections found.
+*/
+
+static void BM_intersectBatchParallel(benchmark::State &state)
+{
+    constexpr int NumCurves = 1 << 12;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> offset(-16, 16);
+
+    std::vector<std::vector<BenchPoint<2, float>>> curves;
+    for (int c = 0; c < NumCurves; ++c)
+    {
+        auto curve = randomPolygon<2, float>(4, c + 1);
+        float dx = offset(rng), dy = offset(rng);
+        for (auto &p : curve)
+        {
+            p.x[0] += dx;
+            p.x[1] += dy;
+        }
+        curves.push_back(curve);
+    }
+
+    Concurrency::WorkStealingPool pool(state.range(0));
+    std::size_t numFound = 0;
+
+    for (auto _ : state)
+    {
+        auto found = Geometry::Bezier::intersectBatch(pool, curves, 1e-4f);
+        numFound = found.size();
+        benchmark::DoNotOptimize(found.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * numFound);
+}
+
+BENCHMARK(BM_intersectBatchParallel)->ArgName("threads")->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+
+/*
+    A full refresh of a TessellationCache of 16384 planar cubics (every curve
+    changed, then requested and waited for once), on pools of 1 to 64
+    threads. Items are polylines made.
+*/
+
+static void BM_tessellationCacheRefresh(benchmark::State &state)
+{
+    constexpr int NumCurves = 1 << 14;
+
+    std::vector<Geometry::Bezier::ControlPolygonSoA<2, float>> curves;
+    for (int c = 0; c < NumCurves; ++c)
+        curves.push_back(Geometry::Bezier::ControlPolygonSoA<2, float>::fromPoints(randomPolygon<2, float>(4, c + 1)));
+
+    Concurrency::WorkStealingPool pool(state.range(0));
+    Geometry::Bezier::TessellationCache<2, float> cache(pool, 1e-3f);
+    for (const auto &curve : curves)
+        cache.addCurve(curve);
+
+    for (auto _ : state)
+    {
+        for (int c = 0; c < NumCurves; ++c)
+            cache.setCurve(c, curves[c]);
+        cache.request(1e-3f);
+        cache.wait();
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumCurves);
+}
+
+BENCHMARK(BM_tessellationCacheRefresh)->ArgName("threads")->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+
+/*
+    The cache's share of a frame of a static scene of 100000 planar cubics,
+    all on screen: request() for every curve, then polyline() for every curve
+    and the size of its vertices, as the editor's paint event does before
+    drawing. Items are curves. Drawing itself (QPainter) is not measured.
+*/
+
+static void BM_tessellationCacheFrame(benchmark::State &state)
+{
+    constexpr int NumCurves = 100000;
+
+    Concurrency::WorkStealingPool pool(Concurrency::WorkStealingPool::defaultNumThreads());
+    Geometry::Bezier::TessellationCache<2, float> cache(pool, 1e-3f);
+    for (int c = 0; c < NumCurves; ++c)
+        cache.addCurve(Geometry::Bezier::ControlPolygonSoA<2, float>::fromPoints(randomPolygon<2, float>(4, c + 1)));
+
+    std::vector<int> visible(NumCurves);
+    for (int c = 0; c < NumCurves; ++c)
+        visible[c] = c;
+
+    cache.request(visible.begin(), visible.end(), 1e-3f);
+    cache.wait();
+
+    for (auto _ : state)
+    {
+        cache.request(visible.begin(), visible.end(), 1e-3f);
+
+        std::size_t numVertices = 0;
+        for (int c : visible)
+            numVertices += cache.polyline(c, 1e-3f)->vertices.size();
+        benchmark::DoNotOptimize(numVertices);
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumCurves);
+}
+
+BENCHMARK(BM_tessellationCacheFrame)->UseRealTime();
+
+/*
+    Elements passed from a producer thread to the benchmark thread through an
+    SpscQueue of 1024 slots.
+*/
+
+static void BM_spscQueueTransfer(benchmark::State &state)
+{
+    constexpr long NumValues = 1 << 20;
+
+    for (auto _ : state)
+    {
+        Concurrency::SpscQueue<long> queue(1024);
+        std::thread producer([&queue] {
+            for (long value = 0; value < NumValues; ++value)
+                while (!queue.tryPush(long(value)))
+                    std::this_thread::yield();
+        });
+
+        long value = 0;
+        for (long count = 0; count < NumValues; ++count)
+            while (!queue.tryPop(value))
+                std::this_thread::yield();
+        benchmark::DoNotOptimize(value);
+
+        producer.join();
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumValues);
+}
+
+BENCHMARK(BM_spscQueueTransfer)->UseRealTime();
+
+int main(int argc, char **argv)
+{
+    registerFixedDegreeBenchmarks();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
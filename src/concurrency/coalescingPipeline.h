@@ -0,0 +1,311 @@
+#ifndef COALESCING_PIPELINE_H
+#define COALESCING_PIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "spscQueue.h"
+#include "workStealingPool.h"
+
+namespace Concurrency
+{
+
+    /**
+        @brief Moves work triggered by input events (such as a drag) off the
+        thread that receives them, keeping only the newest input per key.
+
+        One thread, the owner (the GUI thread), calls submit() with an input
+        for a key, for example the control polygon of the curve being dragged.
+        Inputs for a key that has not been picked up yet replace each other,
+        so however fast the events come, each key has at most one input
+        waiting. A pipeline thread takes all waiting inputs at once, computes
+        `work(key, input)` for them on the pool, and publishes the outputs
+        through an SpscQueue, from which the owner collects them with poll().
+
+        Stale work is dropped at both ends: an output is not published if a
+        newer input for its key arrived while it was being computed, and
+        poll() skips any output that is not for the newest input submitted for
+        its key. So the owner only ever sees the result of its latest edit, or
+        nothing yet, and never blocks on the pipeline except for the brief
+        locks in submit() and poll().
+
+        The ready callback runs on the pipeline thread after every batch that
+        published something, for example to schedule a repaint that polls,
+        and also whenever the queue fills up in the middle of a batch, so an
+        owner that only polls when told to always makes room. Until it does,
+        the pipeline thread sleeps; the poll() that takes outputs out wakes
+        it.
+
+        `work` must not throw, and Key, Input and Output must be default
+        constructible; Key must also work with std::hash.
+    */
+    template< typename Key, typename Input, typename Output >
+    class CoalescingPipeline
+    {
+    public:
+        typedef std::function<Output(const Key &, const Input &)> Work;
+
+        CoalescingPipeline(WorkStealingPool &pool, Work work, std::size_t capacity = 256)
+            : mPool(pool),
+              mWork(std::move(work)),
+              mResults(capacity)
+        {
+            mThread = std::thread([this] { run(); });
+        }
+
+        ~CoalescingPipeline()
+        {
+            stop();
+        }
+
+        CoalescingPipeline(const CoalescingPipeline &) = delete;
+        CoalescingPipeline &operator=(const CoalescingPipeline &) = delete;
+
+        /**
+            @brief Sets the function run on the pipeline thread after outputs
+            have been published. Set it before the first submit().
+        */
+        void setReadyCallback(std::function<void()> callback)
+        {
+            mReadyCallback = std::move(callback);
+        }
+
+        /**
+            @brief Queues `input` for `key`, replacing the input for `key` that
+            is still waiting, if any. Owner only.
+        */
+        void submit(const Key &key, Input input)
+        {
+            std::uint64_t sequence = ++mLastSequence;
+            mLatest[key] = sequence;
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mWaiting[key] = Waiting { sequence, std::move(input) };
+            }
+            mWake.notify_one();
+        }
+
+        /**
+            @brief Calls `consume(key, output)` for every published output that
+            is for the newest input submitted for its key, and returns how many
+            there were. Owner only.
+        */
+        template< typename Consumer >
+        int poll(Consumer consume)
+        {
+            int numConsumed = 0;
+            int numPopped = 0;
+
+            Result result;
+            while (mResults.tryPop(result))
+            {
+                ++numPopped;
+
+                auto latest = mLatest.find(result.key);
+                if (latest == mLatest.end() || latest->second != result.sequence)
+                    continue;
+
+                mLatest.erase(latest);
+                consume(result.key, std::move(result.output));
+                ++numConsumed;
+            }
+
+            // Wakes the pipeline thread if it is waiting for room to publish.
+            if (numPopped > 0)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mRoomMade = true;
+                }
+                mWake.notify_one();
+            }
+
+            return numConsumed;
+        }
+
+        /**
+            @brief Whether an output for the newest input of `key` is still to
+            come. Owner only.
+        */
+        bool isPending(const Key &key) const
+        {
+            return mLatest.count(key) > 0;
+        }
+
+        /**
+            @brief The number of outputs dropped before publication because a
+            newer input had arrived.
+        */
+        std::uint64_t numDropped() const
+        {
+            return mNumDropped.load(std::memory_order_relaxed);
+        }
+
+        /**
+            @brief Finishes the batch in progress, if any, and stops the
+            pipeline thread; waiting inputs are discarded. Called by the
+            destructor, and safe to call more than once.
+        */
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mStopping = true;
+            }
+            mWake.notify_one();
+
+            if (mThread.joinable())
+                mThread.join();
+        }
+
+    private:
+        struct Waiting
+        {
+            std::uint64_t sequence;
+            Input input;
+        };
+
+        struct Job
+        {
+            Key key;
+            std::uint64_t sequence;
+            Input input;
+        };
+
+        struct Result
+        {
+            Key key;
+            std::uint64_t sequence = 0;
+            Output output;
+        };
+
+        void run()
+        {
+            std::vector<Job> jobs;
+            std::vector<Output> outputs;
+            std::vector<char> stale;
+
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    mWake.wait(lock, [this] { return mStopping || !mWaiting.empty(); });
+                    if (mStopping)
+                        return;
+
+                    jobs.clear();
+                    for (auto &waiting : mWaiting)
+                        jobs.push_back(Job { waiting.first, waiting.second.sequence, std::move(waiting.second.input) });
+                    mWaiting.clear();
+                }
+
+                int numJobs = jobs.size();
+                outputs.resize(numJobs);
+                mPool.parallelFor(0, numJobs, 1, [&](int jobIdx) {
+                    outputs[jobIdx] = mWork(jobs[jobIdx].key, jobs[jobIdx].input);
+                });
+
+                // An input that arrived during the batch is newer than the
+                // one just computed for its key.
+                stale.assign(numJobs, 0);
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    for (int jobIdx = 0; jobIdx < numJobs; ++jobIdx)
+                        stale[jobIdx] = mWaiting.count(jobs[jobIdx].key) > 0;
+                }
+
+                // Whether outputs were pushed since the last ready callback.
+                bool unannounced = false;
+                for (int jobIdx = 0; jobIdx < numJobs; ++jobIdx)
+                {
+                    if (stale[jobIdx])
+                    {
+                        mNumDropped.fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                    }
+
+                    Result result { jobs[jobIdx].key, jobs[jobIdx].sequence, std::move(outputs[jobIdx]) };
+                    if (!mResults.tryPush(std::move(result)))
+                    {
+                        // The owner drains the queue on the poll() that the
+                        // callback leads to, so it must hear of the outputs
+                        // already in it before this waits for room.
+                        if (unannounced)
+                            announce();
+
+                        if (!pushWhenRoom(result))
+                            return;
+                    }
+                    unannounced = true;
+                }
+
+                if (unannounced)
+                    announce();
+            }
+        }
+
+        void announce()
+        {
+            if (mReadyCallback)
+                mReadyCallback();
+        }
+
+        /**
+            @brief Pushes `result` once a poll() has made room in the full
+            queue, sleeping until then. Returns false, without pushing, if the
+            pipeline is stopped meanwhile.
+        */
+        bool pushWhenRoom(Result &result)
+        {
+            for (;;)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mRoomMade = false;
+                }
+
+                // A poll() that made room before the flag was cleared did so
+                // before this try, so its room is seen here and not missed.
+                if (mResults.tryPush(std::move(result)))
+                    return true;
+
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWake.wait(lock, [this] { return mStopping || mRoomMade; });
+                if (mStopping)
+                    return false;
+            }
+        }
+
+        WorkStealingPool &mPool;
+        Work mWork;
+        std::function<void()> mReadyCallback;
+
+        // Shared with the pipeline thread, under mMutex.
+        std::mutex mMutex;
+        std::condition_variable mWake;
+        std::unordered_map<Key, Waiting> mWaiting;
+        bool mStopping = false;
+        bool mRoomMade = false;
+
+        SpscQueue<Result> mResults;
+        std::atomic<std::uint64_t> mNumDropped { 0 };
+
+        // The owner's: the sequence number of the newest input for every key
+        // whose output has not been consumed yet.
+        std::unordered_map<Key, std::uint64_t> mLatest;
+        std::uint64_t mLastSequence = 0;
+
+        std::thread mThread;
+    };
+
+}
+
+#endif // COALESCING_PIPELINE_H
@@ -0,0 +1,128 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Concurrency
+{
+
+    /**
+        @brief A bounded lock-free queue between exactly one producer thread,
+        which calls tryPush(), and exactly one consumer thread, which calls
+        tryPop().
+
+        The elements live in a ring buffer whose size is a power of two. The
+        producer owns the tail index and the consumer the head index; each
+        publishes its index with a release store and reads the other's with
+        an acquire load, which is all the synchronization the elements need.
+        Each side also keeps its last view of the other's index and rereads it
+        only when the queue looks full (or empty), so in the common case a
+        push or pop touches no cache line written by the other thread.
+
+        T must be default constructible and move assignable; popped slots keep
+        a moved-from element until they are reused.
+    */
+    template< typename T >
+    class SpscQueue
+    {
+    public:
+        /**
+            @brief A queue of at least `capacity` elements.
+        */
+        explicit SpscQueue(std::size_t capacity)
+            : mSlots(roundUpToPowerOfTwo(capacity)),
+              mMask(mSlots.size() - 1)
+        {
+        }
+
+        SpscQueue(const SpscQueue &) = delete;
+        SpscQueue &operator=(const SpscQueue &) = delete;
+
+        std::size_t capacity() const
+        {
+            return mSlots.size();
+        }
+
+        /**
+            @brief Appends `value`, unless the queue is full. Producer only.
+            Returns whether `value` was moved into the queue.
+        */
+        bool tryPush(T &&value)
+        {
+            std::size_t tail = mTail.load(std::memory_order_relaxed);
+            if (tail - mCachedHead == mSlots.size())
+            {
+                mCachedHead = mHead.load(std::memory_order_acquire);
+                if (tail - mCachedHead == mSlots.size())
+                    return false;
+            }
+
+            mSlots[tail & mMask] = std::move(value);
+            mTail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool tryPush(const T &value)
+        {
+            T copy = value;
+            return tryPush(std::move(copy));
+        }
+
+        /**
+            @brief Moves the oldest element to `value`, unless the queue is
+            empty. Consumer only. Returns whether there was an element.
+        */
+        bool tryPop(T &value)
+        {
+            std::size_t head = mHead.load(std::memory_order_relaxed);
+            if (head == mCachedTail)
+            {
+                mCachedTail = mTail.load(std::memory_order_acquire);
+                if (head == mCachedTail)
+                    return false;
+            }
+
+            value = std::move(mSlots[head & mMask]);
+            mHead.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+            @brief Whether the queue is empty. Exact on the consumer thread;
+            elsewhere it may be out of date by the time it returns.
+        */
+        bool empty() const
+        {
+            return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+        }
+
+    private:
+        static std::size_t roundUpToPowerOfTwo(std::size_t n)
+        {
+            std::size_t result = 1;
+            while (result < n)
+                result *= 2;
+            return result;
+        }
+
+        // The indices count every push and pop since construction and are
+        // reduced to slots with mMask; since the capacity is a power of two,
+        // their differences stay right when they wrap around.
+        std::vector<T> mSlots;
+        std::size_t mMask;
+
+        // Written by the consumer.
+        alignas(64) std::atomic<std::size_t> mHead { 0 };
+        std::size_t mCachedTail = 0;
+
+        // Written by the producer.
+        alignas(64) std::atomic<std::size_t> mTail { 0 };
+        std::size_t mCachedHead = 0;
+    };
+
+}
+
+#endif // SPSC_QUEUE_H
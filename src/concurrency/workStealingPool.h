@@ -0,0 +1,288 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Concurrency
+{
+
+    /**
+        @brief A fixed-size thread pool in which every worker owns a queue of
+        tasks and steals from the other queues when its own runs dry.
+
+        A worker runs the tasks of its own queue newest-first (which keeps the
+        data of tasks it just spawned in its cache) and steals the oldest tasks
+        of other queues. Tasks submitted from outside the pool are distributed
+        over the queues round-robin.
+
+        `numThreads` counts the thread that calls parallelFor() as well, so a
+        pool of one thread has no workers and runs everything inline.
+    */
+    class WorkStealingPool
+    {
+    public:
+        explicit WorkStealingPool(int numThreads = defaultNumThreads())
+        {
+            int numWorkers = numThreads > 1 ? numThreads - 1 : 0;
+
+            for (int idx = 0; idx < numWorkers; ++idx)
+                mQueues.emplace_back(new Queue);
+
+            for (int idx = 0; idx < numWorkers; ++idx)
+                mWorkers.emplace_back([this, idx] { workerLoop(idx); });
+        }
+
+        ~WorkStealingPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mSleepMutex);
+                mStopping = true;
+            }
+            mWake.notify_all();
+
+            for (std::thread &worker : mWorkers)
+                worker.join();
+        }
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        /**
+            @brief The number of threads in the system, or 1 if unknown.
+        */
+        static int defaultNumThreads()
+        {
+            unsigned int n = std::thread::hardware_concurrency();
+            return n > 0 ? int(n) : 1;
+        }
+
+        /**
+            @brief The number of threads that run tasks, including the caller of
+            parallelFor().
+        */
+        int numThreads() const
+        {
+            return mWorkers.size() + 1;
+        }
+
+        /**
+            @brief Queues `task` to be run on some worker. Tasks submitted from a
+            worker go to that worker's own queue. Without workers, the task is
+            run immediately.
+        */
+        void submit(std::function<void()> task)
+        {
+            if (mQueues.empty())
+            {
+                task();
+                return;
+            }
+
+            int idx = currentQueue();
+            if (idx < 0)
+                idx = mNextQueue.fetch_add(1, std::memory_order_relaxed) % mQueues.size();
+
+            {
+                std::lock_guard<std::mutex> lock(mQueues[idx]->mutex);
+                mQueues[idx]->tasks.push_back(std::move(task));
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mSleepMutex);
+                ++mPending;
+            }
+            mWake.notify_one();
+        }
+
+        /**
+            @brief Calls `body(i)` for every i in [begin, end), in chunks of
+            `grainSize` consecutive indices, and returns once all calls are done.
+
+            The calling thread runs queued tasks as well while it waits, and
+            blocks once there are none left to take. If `body` throws, the
+            first exception is rethrown here after all chunks have finished.
+        */
+        template< typename Body >
+        void parallelFor(int begin, int end, int grainSize, Body body)
+        {
+            if (end <= begin)
+                return;
+
+            if (grainSize < 1)
+                grainSize = 1;
+
+            int numChunks = (end - begin + grainSize - 1) / grainSize;
+
+            if (mQueues.empty() || numChunks == 1)
+            {
+                for (int i = begin; i < end; ++i)
+                    body(i);
+                return;
+            }
+
+            // The count of unfinished chunks and the first error, both under
+            // `mutex`. The last chunk to finish decrements and notifies while
+            // holding it, so the caller cannot see zero and return (destroying
+            // all of this) before the notification is over.
+            std::mutex mutex;
+            std::condition_variable finished;
+            int remaining = numChunks;
+            std::exception_ptr error;
+
+            for (int chunk = 0; chunk < numChunks; ++chunk)
+            {
+                int chunkBegin = begin + chunk * grainSize;
+                int chunkEnd = chunkBegin + grainSize < end ? chunkBegin + grainSize : end;
+
+                submit([&, chunkBegin, chunkEnd] {
+                    std::exception_ptr chunkError;
+                    try
+                    {
+                        for (int i = chunkBegin; i < chunkEnd; ++i)
+                            body(i);
+                    }
+                    catch (...)
+                    {
+                        chunkError = std::current_exception();
+                    }
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (chunkError && !error)
+                        error = chunkError;
+                    if (--remaining == 0)
+                        finished.notify_all();
+                });
+            }
+
+            // Help with the queued tasks while there are any, then sleep until
+            // the chunks that other threads have taken are done, rather than
+            // spin for as long as the slowest of them runs.
+            for (;;)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (remaining == 0)
+                        break;
+                }
+
+                if (tryRunOne(currentQueue()))
+                    continue;
+
+                std::unique_lock<std::mutex> lock(mutex);
+                finished.wait(lock, [&remaining] { return remaining == 0; });
+                break;
+            }
+
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        /**
+            @brief The queue of the worker of this pool that is running on the
+            current thread, or -1 if the current thread is not one of them.
+        */
+        int currentQueue() const
+        {
+            return tCurrentPool() == this ? tCurrentQueue() : -1;
+        }
+
+        static const WorkStealingPool *&tCurrentPool()
+        {
+            static thread_local const WorkStealingPool *pool = nullptr;
+            return pool;
+        }
+
+        static int &tCurrentQueue()
+        {
+            static thread_local int queue = -1;
+            return queue;
+        }
+
+        /**
+            @brief Runs one task: the newest one of queue `own` if there is one
+            (and `own` is not -1), otherwise the oldest one of another queue.
+            Returns false if there was nothing to run.
+        */
+        bool tryRunOne(int own)
+        {
+            std::function<void()> task;
+
+            if (own >= 0)
+            {
+                std::lock_guard<std::mutex> lock(mQueues[own]->mutex);
+                if (!mQueues[own]->tasks.empty())
+                {
+                    task = std::move(mQueues[own]->tasks.back());
+                    mQueues[own]->tasks.pop_back();
+                }
+            }
+
+            int numQueues = mQueues.size();
+            for (int offset = 1; !task && offset <= numQueues; ++offset)
+            {
+                int victim = ((own < 0 ? 0 : own) + offset) % numQueues;
+
+                std::lock_guard<std::mutex> lock(mQueues[victim]->mutex);
+                if (!mQueues[victim]->tasks.empty())
+                {
+                    task = std::move(mQueues[victim]->tasks.front());
+                    mQueues[victim]->tasks.pop_front();
+                }
+            }
+
+            if (!task)
+                return false;
+
+            mPending.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            return true;
+        }
+
+        void workerLoop(int idx)
+        {
+            tCurrentPool() = this;
+            tCurrentQueue() = idx;
+
+            for (;;)
+            {
+                if (tryRunOne(idx))
+                    continue;
+
+                std::unique_lock<std::mutex> lock(mSleepMutex);
+                mWake.wait(lock, [this] { return mStopping || mPending.load() > 0; });
+
+                if (mStopping && mPending.load() == 0)
+                    return;
+            }
+        }
+
+        std::vector<std::unique_ptr<Queue>> mQueues;
+        std::vector<std::thread> mWorkers;
+        std::atomic<unsigned int> mNextQueue { 0 };
+
+        // Number of tasks in all queues. It is only increased while holding
+        // mSleepMutex, so that sleeping workers cannot miss a wake-up.
+        std::atomic<int> mPending { 0 };
+        std::mutex mSleepMutex;
+        std::condition_variable mWake;
+        bool mStopping = false;
+    };
+
+}
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,168 @@
+#ifndef ADAPTIVE_TESSELLATION_H
+#define ADAPTIVE_TESSELLATION_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+
+#include "deCasteljau.h"
+#include "controlPolygonSoA.h"
+#include "pointTraits.h"
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief Measures how far the `numPoints` points starting at `points` are
+        from a straight line: the largest distance between b_i and the point
+        i/n of the way from b_0 to b_n.
+
+        By the convex hull property (applied to the difference between the
+        curve and the segment from b_0 to b_n traversed at constant speed), the
+        curve is never farther than this from that segment.
+
+        PointTraits<Point> must be specialized, and the following expression
+        must be valid with the Point type:
+            <Point> + <float> * (<Point> - <Point>)
+    */
+    template< typename Point >
+    inline typename PointTraits<Point>::Scalar flatness(const Point *points, int numPoints)
+    {
+        typedef PointTraits<Point> Traits;
+        typedef typename Traits::Scalar Scalar;
+
+        int degree = numPoints - 1;
+        Scalar maxDistanceSquared = 0;
+
+        for (int i = 1; i < degree; ++i)
+        {
+            Point onChord = points[0] + (float(i) / degree) * (points[degree] - points[0]);
+
+            Scalar distanceSquared = 0;
+            for (int d = 0; d < Traits::Dimension; ++d)
+            {
+                Scalar delta = Traits::coordinate(points[i], d) - Traits::coordinate(onChord, d);
+                distanceSquared += delta * delta;
+            }
+
+            maxDistanceSquared = std::max(maxDistanceSquared, distanceSquared);
+        }
+
+        return std::sqrt(maxDistanceSquared);
+    }
+
+
+    /**
+        @brief The number of uniform parameter steps after which the polyline
+        through the samples of a curve is within `tolerance` of it, by Wang's
+        formula: with M the largest second difference |b_(i+2) - 2 b_(i+1) + b_i|
+        of the control polygon of degree n, N steps suffice once
+            n (n - 1) M / (8 N^2) <= tolerance.
+        The result is clamped to [1, maxSegments]. `tolerance` must be
+        positive.
+
+        Unlike tessellateAdaptive(), this picks one step size for the whole
+        curve, which is not as economical but needs no recursion, so it is easy
+        to run in parallel for every sample (for example, on a GPU).
+    */
+    template< int Dim, typename Scalar >
+    inline int uniformSegmentCount(ControlPolygonSoAView<Dim, Scalar> polygon, Scalar tolerance,
+                                   int maxSegments)
+    {
+        assert( tolerance > 0 );
+        assert( maxSegments >= 1 );
+
+        int degree = polygon.size() - 1;
+
+        Scalar maxSquared = 0;
+        for (int i = 0; i + 2 <= degree; ++i)
+        {
+            Scalar squared = 0;
+            for (int d = 0; d < Dim; ++d)
+            {
+                Scalar difference = polygon(d, i + 2) - 2 * polygon(d, i + 1) + polygon(d, i);
+                squared += difference * difference;
+            }
+            maxSquared = std::max(maxSquared, squared);
+        }
+
+        Scalar bound = degree * (degree - 1) * std::sqrt(maxSquared) / (8 * tolerance);
+        Scalar steps = std::ceil(std::sqrt(bound));
+
+        return steps >= Scalar(maxSegments) ? maxSegments : std::max(1, int(steps));
+    }
+
+
+    /**
+        @brief Approximates the curve of `points` by a polyline that is never
+        farther than `tolerance` from it, and writes the polyline's vertices to
+        `out` in order (starting with the first control point and ending with
+        the last one).
+
+        The curve is split in half with split() until the control polygon of
+        every piece passes the flatness() test, or until the piece has been
+        split `maxDepth` times. Pieces waiting to be processed are kept on an
+        explicit stack in one preallocated buffer, so the whole tessellation
+        performs a fixed number of allocations regardless of the curve.
+
+        PointTraits<Point> must be specialized, and the following expression
+        must be valid with the Point type:
+            <Point> + <float> * (<Point> - <Point>)
+
+        Returns the output iterator one past the last point written.
+    */
+    template< typename Point, typename OutputIterator >
+    inline OutputIterator tessellateAdaptive(const std::vector<Point> &points, float tolerance,
+                                             OutputIterator out, int maxDepth = 16)
+    {
+        int numPoints = points.size();
+
+        *out = points[0];
+        ++out;
+
+        if (numPoints < 2)
+            return out;
+
+        // Every split replaces one piece by two, so there are never more than
+        // maxDepth + 1 pieces on the stack.
+        std::vector<Point> stack;
+        stack.reserve((maxDepth + 1) * numPoints);
+        std::vector<int> depths;
+        depths.reserve(maxDepth + 1);
+
+        std::vector<Point> left(points);
+
+        stack.insert(stack.end(), points.begin(), points.end());
+        depths.push_back(0);
+
+        while (!depths.empty())
+        {
+            Point *top = stack.data() + stack.size() - numPoints;
+            int depth = depths.back();
+
+            if (depth >= maxDepth || flatness(top, numPoints) <= tolerance)
+            {
+                *out = top[numPoints - 1];
+                ++out;
+
+                stack.erase(stack.end() - numPoints, stack.end());
+                depths.pop_back();
+                continue;
+            }
+
+            // The top piece becomes its right half, and the left half goes on
+            // top of it so that the pieces are emitted from left to right.
+            split(top, numPoints, 0.5f, left.data());
+            depths.back() = depth + 1;
+
+            stack.insert(stack.end(), left.begin(), left.end());
+            depths.push_back(depth + 1);
+        }
+
+        return out;
+    }
+
+}
+
+#endif // ADAPTIVE_TESSELLATION_H
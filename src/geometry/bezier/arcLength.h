@@ -0,0 +1,404 @@
+#ifndef ARC_LENGTH_H
+#define ARC_LENGTH_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include <cassert>
+
+#include "bezierCurve.h"
+#include "controlPolygonSoA.h"
+#include "pointTraits.h"
+
+namespace Geometry::Bezier
+{
+
+    namespace detail
+    {
+
+        /**
+            @brief Stores `x`, which lies in [0, scale], as a `Storage`: as is
+            for floating-point types, and as a fraction of `scale` using the
+            whole range of an unsigned integer type.
+        */
+        template< typename Storage, typename Coordinate >
+        inline Storage encodeKnot(Coordinate x, Coordinate scale)
+        {
+            if constexpr (std::is_floating_point<Storage>::value)
+            {
+                return Storage(x);
+            }
+            else
+            {
+                static_assert( std::is_unsigned<Storage>::value, "Knots are stored as floats or unsigned integers" );
+
+                constexpr Coordinate top = std::numeric_limits<Storage>::max();
+                Coordinate fraction = scale > 0 ? std::clamp(x / scale, Coordinate(0), Coordinate(1)) : 0;
+                return Storage(std::lround(fraction * top));
+            }
+        }
+
+        template< typename Storage, typename Coordinate >
+        inline Coordinate decodeKnot(Storage x, Coordinate scale)
+        {
+            if constexpr (std::is_floating_point<Storage>::value)
+                return Coordinate(x);
+            else
+                return Coordinate(x) / std::numeric_limits<Storage>::max() * scale;
+        }
+
+
+        /**
+            @brief The cubic Hermite interpolation of t(s) between the knots
+            (s0, t0) and (s0 + h, t1) at s0 + `ds`, with slopes dt/ds of 1 /
+            speed. The slope blows up at a cusp, where the secant slope is used
+            instead.
+        */
+        template< typename Coordinate >
+        inline Coordinate hermiteParameter(Coordinate ds, Coordinate h, Coordinate t0, Coordinate t1,
+                                           Coordinate speed0, Coordinate speed1)
+        {
+            Coordinate u = std::clamp(ds / h, Coordinate(0), Coordinate(1));
+
+            Coordinate secant = (t1 - t0) / h;
+            Coordinate m0 = speed0 * secant > Coordinate(0.25) ? 1 / speed0 : secant;
+            Coordinate m1 = speed1 * secant > Coordinate(0.25) ? 1 / speed1 : secant;
+
+            Coordinate u2 = u * u, u3 = u2 * u;
+            Coordinate t = (2 * u3 - 3 * u2 + 1) * t0 + (u3 - 2 * u2 + u) * h * m0
+                           + (-2 * u3 + 3 * u2) * t1 + (u3 - u2) * h * m1;
+
+            return std::clamp(t, t0, t1);
+        }
+
+    }
+
+
+    /**
+        @brief A table of the arc length of a curve at a set of parameters,
+        for moving along the curve at constant speed.
+
+        The length is the integral of the speed |C'(t)|, evaluated on the
+        curve's cached hodograph with 5-point Gauss-Legendre quadrature. An interval is
+        halved until the quadrature of the halves agrees with that of the whole
+        within `tolerance` times the interval's width, so the total length is
+        accurate to about `tolerance`, and until the interpolation below finds
+        the interval's midpoint within `tolerance` along the curve. The ends
+        and midpoints of the accepted intervals become the knots of the table,
+        each with its parameter, its length and the speed there.
+
+        parameter() maps a length back to a parameter with a binary search
+        over the knots, followed by cubic Hermite interpolation of t(s), whose
+        slope at a knot is 1 / speed; it can be polished further by Newton
+        steps on the exact length.
+
+        Knots are stored as `Storage`, by default the coordinate type. With
+        std::uint16_t, every knot takes 6 bytes, and parameters and lengths are
+        rounded to 1/65535 of their range.
+
+        The table remembers the version() of the curve it was built from, and
+        refresh() rebuilds it only after the curve has changed (or after
+        another curve has been assigned to it), so it can be refreshed every
+        frame at the cost of comparing two numbers.
+
+        Besides PointTraits<Point>, this needs PointTraits of the curve's
+        Vector type, which is usually Point itself.
+    */
+    template< typename Point, typename Scalar = float, typename Storage = typename PointTraits<Point>::Scalar >
+    class ArcLengthTable
+    {
+        typedef PointTraits<Point> Traits;
+        static constexpr int Dim = Traits::Dimension;
+
+    public:
+        typedef typename Traits::Scalar Coordinate;
+
+        ArcLengthTable(const BezierCurve<Point, Scalar> &curve, Coordinate tolerance = Coordinate(1e-4),
+                       int maxDepth = 12)
+            : mTolerance(tolerance),
+              mMaxDepth(maxDepth)
+        {
+            build(curve);
+        }
+
+        /**
+            @brief Rebuilds the table if `curve` has changed since it was
+            built. Returns whether it was rebuilt.
+        */
+        bool refresh(const BezierCurve<Point, Scalar> &curve)
+        {
+            if (curve.version() == mVersion)
+                return false;
+
+            build(curve);
+            return true;
+        }
+
+        /**
+            @brief Whether the table was built from the current version of
+            `curve`.
+        */
+        bool isCurrent(const BezierCurve<Point, Scalar> &curve) const
+        {
+            return curve.version() == mVersion;
+        }
+
+        /**
+            @brief The length of the whole curve.
+        */
+        Coordinate length() const
+        {
+            return mLength;
+        }
+
+        int numKnots() const
+        {
+            return mParams.size();
+        }
+
+        /**
+            @brief The parameter at which the length of the curve from 0 is
+            `s`, interpolated between the knots. `s` is clamped to
+            [0, length()].
+        */
+        Scalar parameter(Coordinate s) const
+        {
+            int k = interval(s);
+
+            Coordinate t0 = knotParam(k), t1 = knotParam(k + 1);
+            Coordinate s0 = knotLength(k), s1 = knotLength(k + 1);
+            Coordinate h = s1 - s0;
+
+            if (!(h > 0))
+                return Scalar(t0);
+            return Scalar(detail::hermiteParameter(s - s0, h, t0, t1, knotSpeed(k), knotSpeed(k + 1)));
+        }
+
+        /**
+            @brief The parameter at which the length of the curve is `s`,
+            interpolated as above and then polished with `iterations` Newton
+            steps t -= (length(t) - s) / speed(t), safeguarded by bisection.
+        */
+        Scalar parameter(Coordinate s, int iterations)
+        {
+            int k = interval(s);
+            Coordinate t0 = knotParam(k);
+            Coordinate s0 = knotLength(k);
+
+            // The root stays bracketed by [lower, upper]; a step that leaves
+            // the bracket, as near a cusp, is replaced by bisection.
+            Coordinate lower = t0, upper = knotParam(k + 1);
+            Coordinate t = parameter(s);
+            for (int iteration = 0; iteration < iterations; ++iteration)
+            {
+                Coordinate error = s0 + integrate(t0, t) - s;
+                if (error == 0)
+                    break;
+                if (error > 0)
+                    upper = t;
+                else
+                    lower = t;
+
+                Coordinate speed = this->speed(t);
+                Coordinate next = speed > 0 ? t - error / speed : lower;
+                t = next >= lower && next <= upper ? next : (lower + upper) / 2;
+            }
+
+            return Scalar(t);
+        }
+
+        /**
+            @brief The length of the curve from 0 to t: the length at the knot
+            before t plus a quadrature from there.
+        */
+        Coordinate length(detail::NonDeduced<Scalar> t)
+        {
+            Coordinate tc = std::clamp(Coordinate(t), Coordinate(0), Coordinate(1));
+
+            auto after = std::upper_bound(mParams.begin(), mParams.end(),
+                                          detail::encodeKnot<Storage>(tc, Coordinate(1)));
+            int k = std::clamp<int>(after - mParams.begin() - 1, 0, numKnots() - 1);
+
+            return knotLength(k) + integrate(knotParam(k), tc);
+        }
+
+        /**
+            @brief The speed |C'(t)| of the curve, from its hodograph.
+        */
+        Coordinate speed(Coordinate t)
+        {
+            int numPoints = mHodographSize;
+            Coordinate result = 0;
+
+            for (int d = 0; d < Dim; ++d)
+            {
+                Coordinate derivative = numPoints > 0
+                    ? detail::deCasteljauRow(mHodograph.data() + d * numPoints, numPoints, t, mScratch.data())
+                    : 0;
+                result += derivative * derivative;
+            }
+
+            return std::sqrt(result);
+        }
+
+    private:
+        struct Knot
+        {
+            Coordinate t, s, speed;
+        };
+
+        void build(const BezierCurve<Point, Scalar> &curve)
+        {
+            typedef PointTraits<typename BezierCurve<Point, Scalar>::Vector> VectorTraits;
+            static_assert( VectorTraits::Dimension == Dim, "Vector dimension does not match the points" );
+
+            mVersion = curve.version();
+
+            int degree = curve.degree();
+
+            mHodographSize = degree;
+            mHodograph.resize(Dim * degree);
+            mScratch.resize(std::max(degree, 1));
+            if (degree > 0)
+            {
+                const auto &hodograph = curve.hodograph(1);
+                for (int d = 0; d < Dim; ++d)
+                    for (int i = 0; i < degree; ++i)
+                        mHodograph[d * degree + i] = VectorTraits::coordinate(hodograph[i], d);
+            }
+
+            std::vector<Knot> knots;
+            knots.push_back(Knot { 0, 0, speed(0) });
+
+            // Two forced levels keep a whole curve from passing the test by
+            // accident (for example, when the speed is symmetric).
+            Coordinate s = 0;
+            for (int quarter = 0; quarter < 4; ++quarter)
+            {
+                Coordinate a = Coordinate(quarter) / 4, b = Coordinate(quarter + 1) / 4;
+                subdivide(a, b, integrate(a, b), mMaxDepth, s, knots);
+            }
+
+            mLength = s;
+            mMaxSpeed = 0;
+            for (const Knot &knot : knots)
+                mMaxSpeed = std::max(mMaxSpeed, knot.speed);
+
+            mParams.clear();
+            mLengths.clear();
+            mSpeeds.clear();
+            for (const Knot &knot : knots)
+            {
+                mParams.push_back(detail::encodeKnot<Storage>(knot.t, Coordinate(1)));
+                mLengths.push_back(detail::encodeKnot<Storage>(knot.s, mLength));
+                mSpeeds.push_back(detail::encodeKnot<Storage>(knot.speed, mMaxSpeed));
+            }
+        }
+
+        /**
+            @brief Adds the knots of [a, b], whose quadrature is `whole`, to
+            `knots`, and adds its length to `s`.
+        */
+        void subdivide(Coordinate a, Coordinate b, Coordinate whole, int depth, Coordinate &s,
+                       std::vector<Knot> &knots)
+        {
+            Coordinate middle = (a + b) / 2;
+            Coordinate left = integrate(a, middle);
+            Coordinate right = integrate(middle, b);
+
+            // The halves must agree with the whole, and the interpolation of
+            // t(s) across [a, b] must find the middle.
+            Coordinate speedA = knots.back().speed, speedM = speed(middle), speedB = speed(b);
+            bool accurate = std::abs(left + right - whole) <= mTolerance * (b - a);
+            if (accurate && left + right > 0)
+            {
+                Coordinate t = detail::hermiteParameter(left, left + right, a, b, speedA, speedB);
+                accurate = std::abs(t - middle) * speedM <= mTolerance;
+            }
+
+            if (depth == 0 || accurate)
+            {
+                knots.push_back(Knot { middle, s + left, speedM });
+                s += left + right;
+                knots.push_back(Knot { b, s, speedB });
+                return;
+            }
+
+            subdivide(a, middle, left, depth - 1, s, knots);
+            subdivide(middle, b, right, depth - 1, s, knots);
+        }
+
+        /**
+            @brief The 5-point Gauss-Legendre quadrature of the speed on
+            [a, b].
+        */
+        Coordinate integrate(Coordinate a, Coordinate b)
+        {
+            static constexpr Coordinate nodes[5] = {
+                Coordinate(-0.9061798459386640), Coordinate(-0.5384693101056831), Coordinate(0),
+                Coordinate(0.5384693101056831), Coordinate(0.9061798459386640)
+            };
+            static constexpr Coordinate weights[5] = {
+                Coordinate(0.2369268850561891), Coordinate(0.4786286704993665), Coordinate(0.5688888888888889),
+                Coordinate(0.4786286704993665), Coordinate(0.2369268850561891)
+            };
+
+            Coordinate center = (a + b) / 2, halfWidth = (b - a) / 2;
+
+            Coordinate result = 0;
+            for (int node = 0; node < 5; ++node)
+                result += weights[node] * speed(center + halfWidth * nodes[node]);
+
+            return halfWidth * result;
+        }
+
+        /**
+            @brief The index of the knot interval [k, k + 1] that contains the
+            length `s`.
+        */
+        int interval(Coordinate s) const
+        {
+            auto after = std::upper_bound(mLengths.begin(), mLengths.end(),
+                                          detail::encodeKnot<Storage>(std::max(s, Coordinate(0)), mLength));
+            return std::clamp<int>(after - mLengths.begin() - 1, 0, numKnots() - 2);
+        }
+
+        Coordinate knotParam(int k) const
+        {
+            return detail::decodeKnot(mParams[k], Coordinate(1));
+        }
+
+        Coordinate knotLength(int k) const
+        {
+            return detail::decodeKnot(mLengths[k], mLength);
+        }
+
+        Coordinate knotSpeed(int k) const
+        {
+            return detail::decodeKnot(mSpeeds[k], mMaxSpeed);
+        }
+
+        Coordinate mTolerance;
+        int mMaxDepth;
+        std::uint64_t mVersion;
+
+        // mHodograph[d * mHodographSize + i] is coordinate d of the `i`th
+        // control point of the hodograph.
+        int mHodographSize;
+        std::vector<Coordinate> mHodograph;
+        std::vector<Coordinate> mScratch;
+
+        Coordinate mLength;
+        Coordinate mMaxSpeed;
+
+        std::vector<Storage> mParams;
+        std::vector<Storage> mLengths;
+        std::vector<Storage> mSpeeds;
+    };
+
+}
+
+#endif // ARC_LENGTH_H
@@ -0,0 +1,272 @@
+#ifndef BEZIER_CURVE_H
+#define BEZIER_CURVE_H
+
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <cstdint>
+#include <cassert>
+
+#include "deCasteljau.h"
+
+namespace Geometry::Bezier
+{
+
+    namespace detail
+    {
+
+        /**
+            @brief A curve version that has never been handed out before, by
+            any BezierCurve in the program.
+        */
+        inline std::uint64_t nextCurveVersion()
+        {
+            static std::atomic<std::uint64_t> lastVersion { 0 };
+            return lastVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+    }
+
+
+    /**
+        @brief A point on a curve together with the first two derivatives of
+        the curve there.
+    */
+    template< typename Point, typename Vector >
+    struct CurveDerivatives
+    {
+        Point position;
+        Vector firstDerivative;
+        Vector secondDerivative;
+    };
+
+
+    /**
+        @brief A Bezier curve given by its control polygon, with cached
+        hodographs (the control polygons of its derivatives).
+
+        The position and the first two derivatives at a parameter are found
+        with a single de Casteljau scheme by derivatives(): the derivatives
+        only depend on the last three columns of the scheme, so no hodograph is
+        needed for them. Derivatives of any order are available from the
+        hodographs, which are computed the first time they are asked for and
+        kept until a control point changes.
+
+        Every curve is given a new version() when it is made and whenever its
+        control points change, so that objects that cache something about a
+        curve can tell when to recompute it. Versions come from one counter
+        shared by all curves, so two curves only have the same version if one
+        is a copy of the other with the same control points.
+
+        The hodographs are cached by const member functions, so a curve must
+        not be used from several threads at once.
+
+        Besides the usual requirement of affine combinations
+            <Point> + <Scalar> * (<Point> - <Point>)
+        this needs differences of points to support
+            <Point> + <Vector>, <Vector> + <Vector>, <Scalar> * <Vector>, <Vector> - <Vector>
+    */
+    template< typename Point, typename Scalar = float >
+    class BezierCurve
+    {
+    public:
+        typedef decltype(std::declval<Point>() - std::declval<Point>()) Vector;
+        typedef CurveDerivatives<Point, Vector> Derivatives;
+
+        explicit BezierCurve(const std::vector<Point> &points)
+            : mPoints(points),
+              mVersion(detail::nextCurveVersion())
+        {
+        }
+
+        /**
+            @brief The degree of the curve.
+        */
+        int degree() const
+        {
+            return mPoints.size() - 1;
+        }
+
+        /**
+            @brief The control points.
+        */
+        const std::vector<Point> &points() const
+        {
+            return mPoints;
+        }
+
+        /**
+            @brief A number that changes whenever the control points change,
+            and that no curve with other control points has.
+        */
+        std::uint64_t version() const
+        {
+            return mVersion;
+        }
+
+        /**
+            @brief Replaces the `pointIdx`th control point by `p`.
+        */
+        void setPoint(int pointIdx, const Point &p)
+        {
+            mPoints[pointIdx] = p;
+            invalidate();
+        }
+
+        /**
+            @brief Replaces all control points. The degree may change.
+        */
+        void setPoints(const std::vector<Point> &points)
+        {
+            mPoints = points;
+            invalidate();
+        }
+
+        /**
+            @brief Evaluates the curve at t with deCasteljau().
+        */
+        Point operator() (detail::NonDeduced<Scalar> t) const
+        {
+            return deCasteljau<Scalar>(mPoints, t);
+        }
+
+        /**
+            @brief Evaluates the curve at t using the scratch memory of
+            `workspace`.
+        */
+        Point operator() (detail::NonDeduced<Scalar> t, DeCasteljauWorkspace<Point> &workspace) const
+        {
+            return deCasteljau<Scalar>(mPoints, t, workspace);
+        }
+
+        /**
+            @brief The control polygon of the `order`th derivative of the curve,
+            which has degree() - order + 1 points: the `order`th forward
+            differences of the control points, scaled by n! / (n - order)!.
+            `order` must be between 1 and degree().
+
+            Computing the hodograph of some order computes all lower orders as
+            well. They are cached until the control points change.
+        */
+        const std::vector<Vector> &hodograph(int order) const
+        {
+            assert( 1 <= order && order <= degree() );
+
+            int n = degree();
+
+            while (int(mHodographs.size()) < order)
+            {
+                int k = mHodographs.size() + 1;
+                Scalar scale = Scalar(n - k + 1);
+
+                std::vector<Vector> next;
+                next.reserve(n - k + 1);
+
+                for (int i = 0; i <= n - k; ++i)
+                    next.push_back(k == 1 ? scale * (mPoints[i + 1] - mPoints[i])
+                                          : scale * (mHodographs[k - 2][i + 1] - mHodographs[k - 2][i]));
+
+                mHodographs.push_back(std::move(next));
+            }
+
+            return mHodographs[order - 1];
+        }
+
+        /**
+            @brief Evaluates the `order`th derivative of the curve at t, from
+            the cached hodograph of that order. `order` must be between 1 and
+            degree().
+        */
+        Vector derivative(detail::NonDeduced<Scalar> t, int order) const
+        {
+            return deCasteljau<Scalar>(hodograph(order), t);
+        }
+
+        /**
+            @brief Finds the point of the curve at t together with the first and
+            second derivative there, in one de Casteljau scheme.
+
+            The scheme is run until three points p0, p1, p2 remain. Then
+                C''(t) = n (n - 1) ((p2 - p1) - (p1 - p0))
+            and one more iteration gives q0, q1, with
+                C'(t) = n (q1 - q0),     C(t) = q0 + t (q1 - q0).
+            Derivatives that do not exist for the degree are zero.
+        */
+        Derivatives derivatives(detail::NonDeduced<Scalar> t, DeCasteljauWorkspace<Point> &workspace) const
+        {
+            int n = degree();
+            Vector zero = mPoints[0] - mPoints[0];
+
+            if (n == 0)
+                return Derivatives { mPoints[0], zero, zero };
+
+            Point *p = workspace.load(mPoints);
+
+            for (int iteration = 1; iteration < n - 1; ++iteration)
+                for (int pointIdx = 0; pointIdx < n + 1 - iteration; ++pointIdx)
+                    p[pointIdx] = p[pointIdx] + t * (p[pointIdx + 1] - p[pointIdx]);
+
+            Vector second = zero;
+            if (n >= 2)
+            {
+                second = Scalar(n * (n - 1)) * ((p[2] - p[1]) - (p[1] - p[0]));
+
+                p[0] = p[0] + t * (p[1] - p[0]);
+                p[1] = p[1] + t * (p[2] - p[1]);
+            }
+
+            Vector difference = p[1] - p[0];
+
+            return Derivatives { p[0] + t * difference, Scalar(n) * difference, second };
+        }
+
+        /**
+            @brief Finds the point and the first two derivatives as above,
+            allocating scratch memory for this call.
+        */
+        Derivatives derivatives(detail::NonDeduced<Scalar> t) const
+        {
+            DeCasteljauWorkspace<Point> workspace;
+            return derivatives(t, workspace);
+        }
+
+        /**
+            @brief Finds the point and the first two derivatives at every
+            parameter in [firstParam, lastParam), writing one Derivatives
+            object per parameter to `out`. Scratch memory is allocated once for
+            the whole batch.
+
+            Returns the output iterator one past the last object written.
+        */
+        template< typename ParamIterator, typename OutputIterator >
+        OutputIterator derivatives(ParamIterator firstParam, ParamIterator lastParam, OutputIterator out) const
+        {
+            DeCasteljauWorkspace<Point> workspace;
+
+            for (; firstParam != lastParam; ++firstParam)
+            {
+                *out = derivatives(*firstParam, workspace);
+                ++out;
+            }
+
+            return out;
+        }
+
+    private:
+        void invalidate()
+        {
+            mHodographs.clear();
+            mVersion = detail::nextCurveVersion();
+        }
+
+        std::vector<Point> mPoints;
+
+        // mHodographs[k - 1] is the hodograph of order k.
+        mutable std::vector<std::vector<Vector>> mHodographs;
+
+        std::uint64_t mVersion;
+    };
+
+}
+
+#endif // BEZIER_CURVE_H
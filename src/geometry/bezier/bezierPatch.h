@@ -0,0 +1,263 @@
+#ifndef BEZIER_PATCH_H
+#define BEZIER_PATCH_H
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+#include "deCasteljau.h"
+#include "instrumentation.h"
+#include "../../concurrency/workStealingPool.h"
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief A tensor-product Bezier patch of degree (degreeU, degreeV),
+        given by its grid of control points.
+
+        The grid has `numRows() = degreeV + 1` rows of `numCols() = degreeU + 1`
+        points each, stored row after row. Every row is the control polygon of
+        a curve in u, and the point of the patch at (u, v) is found by
+        evaluating every row at u, which gives the control polygon of a curve
+        in v, and evaluating that at v.
+    */
+    template< typename Point >
+    class BezierPatch
+    {
+    public:
+        /**
+            @brief A patch of the given degrees with the control points
+            `points`, `points[row * (degreeU + 1) + col]` being the `col`th
+            point of the `row`th row.
+        */
+        BezierPatch(int degreeU, int degreeV, const std::vector<Point> &points)
+            : mDegreeU(degreeU),
+              mDegreeV(degreeV),
+              mPoints(points)
+        {
+            assert( int(points.size()) == (degreeU + 1) * (degreeV + 1) );
+        }
+
+        int degreeU() const
+        {
+            return mDegreeU;
+        }
+
+        int degreeV() const
+        {
+            return mDegreeV;
+        }
+
+        int numRows() const
+        {
+            return mDegreeV + 1;
+        }
+
+        int numCols() const
+        {
+            return mDegreeU + 1;
+        }
+
+        /**
+            @brief The control points, row after row.
+        */
+        const std::vector<Point> &points() const
+        {
+            return mPoints;
+        }
+
+        /**
+            @brief The `numCols()` control points of the `row`th row.
+        */
+        const Point *row(int row) const
+        {
+            return mPoints.data() + row * numCols();
+        }
+
+        const Point &operator() (int row, int col) const
+        {
+            return mPoints[row * numCols() + col];
+        }
+
+        void setPoint(int row, int col, const Point &p)
+        {
+            mPoints[row * numCols() + col] = p;
+        }
+
+    private:
+        int mDegreeU;
+        int mDegreeV;
+        std::vector<Point> mPoints;
+    };
+
+
+    /**
+        @brief Caller-owned scratch memory for evaluating and tessellating
+        patches: one polygon of `numRows()` points for the curve in v, and one
+        row to run the de Casteljau algorithm in.
+
+        Like DeCasteljauWorkspace, it grows to fit the largest patch it has
+        been used with and keeps that memory, so after the first patch (or
+        after reserve()) nothing is allocated. A workspace must not be shared
+        between threads.
+    */
+    template< typename Point >
+    class BezierPatchWorkspace
+    {
+    public:
+        /**
+            @brief Makes room for patches like `patch`.
+        */
+        void reserve(const BezierPatch<Point> &patch)
+        {
+            fit(mCurve, patch.numRows(), patch(0, 0));
+            fit(mScratch, std::max(patch.numRows(), patch.numCols()), patch(0, 0));
+        }
+
+        /**
+            @brief Evaluates every row of `patch` at u, making the control
+            polygon of the curve v -> patch(u, v), and returns its first point.
+        */
+        template< typename Scalar >
+        Point *curveAt(const BezierPatch<Point> &patch, Scalar u)
+        {
+            reserve(patch);
+
+            int numCols = patch.numCols();
+            for (int row = 0; row < patch.numRows(); ++row)
+            {
+                std::copy(patch.row(row), patch.row(row) + numCols, mScratch.begin());
+                mCurve[row] = deCasteljau<Scalar>(mScratch.data(), numCols, u);
+            }
+
+            return mCurve.data();
+        }
+
+        /**
+            @brief Evaluates the curve last made by curveAt() at v, in the
+            workspace's scratch row.
+        */
+        template< typename Scalar >
+        Point evaluateCurve(int numRows, Scalar v)
+        {
+            std::copy(mCurve.begin(), mCurve.begin() + numRows, mScratch.begin());
+            return deCasteljau<Scalar>(mScratch.data(), numRows, v);
+        }
+
+    private:
+        static void fit(std::vector<Point> &buffer, int size, const Point &fill)
+        {
+            if (int(buffer.size()) < size)
+            {
+                if (int(buffer.capacity()) < size)
+                    CAGD_BEZIER_COUNT_ALLOCATION(sizeof(Point) * size);
+                buffer.resize(size, fill);
+            }
+        }
+
+        std::vector<Point> mCurve;
+        std::vector<Point> mScratch;
+    };
+
+
+    /**
+        @brief The point of `patch` at (u, v), evaluating its rows at u and
+        then the resulting curve at v, all in the scratch memory of
+        `workspace`.
+
+        The following expression must be valid with the Point type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+    */
+    template< typename Scalar = float, typename Point >
+    inline Point deCasteljau(const BezierPatch<Point> &patch, detail::NonDeduced<Scalar> u,
+                             detail::NonDeduced<Scalar> v, BezierPatchWorkspace<Point> &workspace)
+    {
+        workspace.curveAt(patch, u);
+        return workspace.template evaluateCurve<Scalar>(patch.numRows(), v);
+    }
+
+
+    /**
+        @brief The point of `patch` at (u, v), with a temporary workspace.
+    */
+    template< typename Scalar = float, typename Point >
+    inline Point deCasteljau(const BezierPatch<Point> &patch, detail::NonDeduced<Scalar> u,
+                             detail::NonDeduced<Scalar> v)
+    {
+        BezierPatchWorkspace<Point> workspace;
+        return deCasteljau<Scalar>(patch, u, v, workspace);
+    }
+
+
+    /**
+        @brief Samples `patch` on a grid of `uSteps + 1` by `vSteps + 1`
+        uniformly spaced parameters, writing the point at
+        (u, v) = (k / uSteps, l / vSteps) to `out[k * (vSteps + 1) + l]`; that
+        is, one run of `vSteps + 1` points per u.
+
+        The rows of the patch are evaluated once per u; the curve in v this
+        gives is then evaluated at every v. For a patch of degree (m, n), a
+        grid point thus costs the n (n + 1) / 2 steps of one curve evaluation,
+        plus its share of the (n + 1) m (m + 1) / 2 steps per u, against
+        (n + 1) m (m + 1) / 2 + n (n + 1) / 2 steps when evaluating every grid
+        point from scratch.
+
+        Everything is computed in the scratch memory of `workspace`, so
+        tessellating a patch through a warmed-up workspace does not allocate.
+
+        Returns the output iterator one past the last point written.
+    */
+    template< typename Scalar = float, typename Point, typename OutputIterator >
+    inline OutputIterator tessellateGrid(const BezierPatch<Point> &patch, int uSteps, int vSteps,
+                                         OutputIterator out, BezierPatchWorkspace<Point> &workspace)
+    {
+        assert( uSteps > 0 && vSteps > 0 );
+
+        for (int k = 0; k <= uSteps; ++k)
+        {
+            workspace.curveAt(patch, Scalar(k) / Scalar(uSteps));
+
+            for (int l = 0; l <= vSteps; ++l)
+            {
+                *out = workspace.template evaluateCurve<Scalar>(patch.numRows(), Scalar(l) / Scalar(vSteps));
+                ++out;
+            }
+        }
+
+        return out;
+    }
+
+
+    /**
+        @brief Samples every patch on a grid with tessellateGrid(). The
+        `(uSteps + 1) * (vSteps + 1)` grid points of patch `c` are written to
+        `out[c * (uSteps + 1) * (vSteps + 1)]` onwards, in the same order.
+
+        Patches are handed to the pool in chunks of `grainSize`, each with its
+        own BezierPatchWorkspace, so memory is allocated per chunk rather than
+        per patch.
+    */
+    template< typename Scalar = float, typename Point, typename RandomAccessIterator >
+    inline void tessellateGridBatch(Concurrency::WorkStealingPool &pool,
+                                    const std::vector<BezierPatch<Point>> &patches,
+                                    int uSteps, int vSteps, RandomAccessIterator out, int grainSize = 4)
+    {
+        int numPatches = patches.size();
+        grainSize = std::max(1, grainSize);
+        int numChunks = (numPatches + grainSize - 1) / grainSize;
+        std::ptrdiff_t gridSize = std::ptrdiff_t(uSteps + 1) * (vSteps + 1);
+
+        pool.parallelFor(0, numChunks, 1, [&] (int chunk) {
+            BezierPatchWorkspace<Point> workspace;
+
+            int end = std::min(numPatches, (chunk + 1) * grainSize);
+            for (int c = chunk * grainSize; c < end; ++c)
+                tessellateGrid<Scalar>(patches[c], uSteps, vSteps, out + c * gridSize, workspace);
+        });
+    }
+
+}
+
+#endif // BEZIER_PATCH_H
@@ -0,0 +1,155 @@
+#ifndef BLOSSOM_EVALUATOR_H
+#define BLOSSOM_EVALUATOR_H
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief The order in which BlossomEvaluator uses the parameters of a
+        query.
+    */
+    enum class BlossomOrder
+    {
+        /**
+            The parameters are used in the order they are given.
+        */
+        AsGiven,
+
+        /**
+            The parameters are sorted first. The blossom is symmetric, so the
+            result is the same (up to rounding), but queries that are
+            permutations of each other, or that differ in only a few values,
+            then share longer prefixes.
+        */
+        Sorted
+    };
+
+
+    /**
+        @brief Computes the blossom of one control polygon for many parameter
+        sequences, reusing the columns of the de Casteljau scheme that the
+        previous sequence has in common with the current one.
+
+        The columns computed for the last query are kept, together with the
+        parameters they were computed with. A query whose first L parameters
+        equal those of the previous query starts from column L, so it only
+        costs (n - L)(n - L + 1) / 2 affine combinations instead of
+        n(n + 1) / 2. Since the columns shrink from left to right, a query
+        that differs in its last few parameters costs almost nothing. For
+        example, the sequences
+            {0, 0, 0}, {0, 0, 0.5}, {0, 0.5, 0.5}, {0.5, 0.5, 0.5}
+        of a subdivision cost 6, 1, 3 and 6 combinations.
+
+        Only one path of prefixes is kept, so queries should be issued in an
+        order in which consecutive ones share prefixes. Parameters are
+        compared exactly.
+
+        The evaluator allocates only in its constructor. The following
+        expression must be valid with the Point type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+    */
+    template< typename Point, typename Scalar = float >
+    class BlossomEvaluator
+    {
+    public:
+        explicit BlossomEvaluator(const std::vector<Point> &points,
+                                  BlossomOrder order = BlossomOrder::AsGiven)
+            : mNumPoints(points.size()),
+              mOrder(order),
+              mScheme((mNumPoints * (mNumPoints + 1)) / 2, points[0])
+        {
+            std::copy(points.begin(), points.end(), mScheme.begin());
+
+            mPrefix.reserve(mNumPoints - 1);
+            mQuery.reserve(mNumPoints - 1);
+        }
+
+        /**
+            @brief The degree of the curve, which is the number of parameters
+            every query must have.
+        */
+        int degree() const
+        {
+            return mNumPoints - 1;
+        }
+
+        /**
+            @brief The number of parameters whose columns are currently cached.
+        */
+        int cachedDepth() const
+        {
+            return mPrefix.size();
+        }
+
+        /**
+            @brief Computes the blossom with the parameters in `params`, whose
+            size must be degree().
+        */
+        Point operator() (const std::vector<Scalar> &params)
+        {
+            return (*this)(params.begin(), params.end());
+        }
+
+        /**
+            @brief Computes the blossom with the parameters in
+            [firstParam, lastParam), of which there must be degree().
+        */
+        template< typename ParamIterator >
+        Point operator() (ParamIterator firstParam, ParamIterator lastParam)
+        {
+            mQuery.assign(firstParam, lastParam);
+            assert( int(mQuery.size()) == mNumPoints - 1 );
+
+            if (mOrder == BlossomOrder::Sorted)
+                std::sort(mQuery.begin(), mQuery.end());
+
+            int depth = 0;
+            int cached = mPrefix.size();
+            while (depth < cached && mPrefix[depth] == mQuery[depth])
+                ++depth;
+
+            mPrefix.resize(depth);
+
+            for (int iteration = depth + 1; iteration < mNumPoints; ++iteration)
+            {
+                Scalar t = mQuery[iteration - 1];
+
+                const Point *prev = column(iteration - 1);
+                Point *next = column(iteration);
+
+                for (int pointIdx = 0; pointIdx < mNumPoints - iteration; ++pointIdx)
+                    next[pointIdx] = prev[pointIdx] + t * (prev[pointIdx + 1] - prev[pointIdx]);
+
+                mPrefix.push_back(t);
+            }
+
+            return column(mNumPoints - 1)[0];
+        }
+
+    private:
+        /**
+            @brief The first point of the `col`th column, laid out like in
+            DeCasteljauScheme.
+        */
+        Point *column(int col)
+        {
+            return mScheme.data() + ((2 * mNumPoints - col + 1) * col) / 2;
+        }
+
+        int mNumPoints;
+        BlossomOrder mOrder;
+
+        std::vector<Point> mScheme;
+
+        // mPrefix[k] is the parameter that column k + 1 was computed with.
+        std::vector<Scalar> mPrefix;
+        std::vector<Scalar> mQuery;
+    };
+
+}
+
+#endif // BLOSSOM_EVALUATOR_H
@@ -0,0 +1,420 @@
+#ifndef BOUNDING_BOX_H
+#define BOUNDING_BOX_H
+
+#include <array>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+
+#include "deCasteljau.h"
+#include "bezierCurve.h"
+#include "controlPolygonSoA.h"
+#include "pointTraits.h"
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief An axis-aligned box, given by its lowest and highest corners.
+
+        By the convex hull property, a Bezier curve lies in the bounding box of
+        its control points, so a curve whose box misses a query region can be
+        rejected without evaluating or subdividing it.
+
+        A default-constructed box is empty: it contains nothing, and extending
+        it by a point gives the box of just that point.
+    */
+    template< int Dim, typename Scalar = float >
+    struct BoundingBox
+    {
+        static constexpr int Dimension = Dim;
+
+        std::array<Scalar, Dim> lower;
+        std::array<Scalar, Dim> upper;
+
+        BoundingBox()
+        {
+            lower.fill(std::numeric_limits<Scalar>::infinity());
+            upper.fill(-std::numeric_limits<Scalar>::infinity());
+        }
+
+        BoundingBox(const std::array<Scalar, Dim> &lower, const std::array<Scalar, Dim> &upper)
+            : lower(lower), upper(upper) {}
+
+        bool isEmpty() const
+        {
+            for (int d = 0; d < Dim; ++d)
+                if (lower[d] > upper[d])
+                    return true;
+            return false;
+        }
+
+        void extend(const std::array<Scalar, Dim> &p)
+        {
+            for (int d = 0; d < Dim; ++d)
+            {
+                lower[d] = std::min(lower[d], p[d]);
+                upper[d] = std::max(upper[d], p[d]);
+            }
+        }
+
+        void extend(const BoundingBox &other)
+        {
+            for (int d = 0; d < Dim; ++d)
+            {
+                lower[d] = std::min(lower[d], other.lower[d]);
+                upper[d] = std::max(upper[d], other.upper[d]);
+            }
+        }
+
+        /**
+            @brief The box grown by `margin` in every direction, for example
+            the pick radius around a point.
+        */
+        BoundingBox inflated(Scalar margin) const
+        {
+            BoundingBox result = *this;
+            for (int d = 0; d < Dim; ++d)
+            {
+                result.lower[d] -= margin;
+                result.upper[d] += margin;
+            }
+            return result;
+        }
+
+        bool contains(const std::array<Scalar, Dim> &p) const
+        {
+            for (int d = 0; d < Dim; ++d)
+                if (p[d] < lower[d] || p[d] > upper[d])
+                    return false;
+            return true;
+        }
+
+        /**
+            @brief Whether the two boxes have a point in common. Boxes that only
+            touch intersect.
+        */
+        bool intersects(const BoundingBox &other) const
+        {
+            for (int d = 0; d < Dim; ++d)
+                if (other.upper[d] < lower[d] || other.lower[d] > upper[d])
+                    return false;
+            return true;
+        }
+
+        /**
+            @brief The squared distance from `p` to the nearest point of the
+            box, which is zero inside it. A lower bound for the squared
+            distance from `p` to anything in the box.
+        */
+        Scalar distanceSquared(const std::array<Scalar, Dim> &p) const
+        {
+            Scalar result = 0;
+            for (int d = 0; d < Dim; ++d)
+            {
+                Scalar outside = std::max({ lower[d] - p[d], Scalar(0), p[d] - upper[d] });
+                result += outside * outside;
+            }
+            return result;
+        }
+    };
+
+
+    /**
+        @brief The BoundingBox type for points of type `Point`, which must have
+        PointTraits.
+    */
+    template< typename Point >
+    using BoundingBoxOf = BoundingBox<PointTraits<Point>::Dimension, typename PointTraits<Point>::Scalar>;
+
+
+    namespace detail
+    {
+
+        template< typename Point >
+        std::array<typename PointTraits<Point>::Scalar, PointTraits<Point>::Dimension>
+        coordinatesOf(const Point &p)
+        {
+            std::array<typename PointTraits<Point>::Scalar, PointTraits<Point>::Dimension> result;
+            for (int d = 0; d < PointTraits<Point>::Dimension; ++d)
+                result[d] = PointTraits<Point>::coordinate(p, d);
+            return result;
+        }
+
+        template< typename Scalar, std::size_t Dim >
+        Scalar distanceSquared(const std::array<Scalar, Dim> &p, const std::array<Scalar, Dim> &q)
+        {
+            Scalar result = 0;
+            for (std::size_t d = 0; d < Dim; ++d)
+                result += (p[d] - q[d]) * (p[d] - q[d]);
+            return result;
+        }
+
+    }
+
+
+    /**
+        @brief The bounding box of the points in [first, last), which contains
+        the curve they are the control points of.
+    */
+    template< typename InputIterator >
+    inline auto boundingBox(InputIterator first, InputIterator last)
+    {
+        typedef typename std::iterator_traits<InputIterator>::value_type Point;
+
+        BoundingBoxOf<Point> box;
+        for (; first != last; ++first)
+            box.extend(detail::coordinatesOf(*first));
+        return box;
+    }
+
+
+    /**
+        @brief The bounding box of the control points in `points`.
+    */
+    template< typename Point, typename Allocator >
+    inline BoundingBoxOf<Point> boundingBox(const std::vector<Point, Allocator> &points)
+    {
+        return boundingBox(points.begin(), points.end());
+    }
+
+
+    /**
+        @brief The bounding box of a structure-of-arrays control polygon, found
+        one coordinate array at a time.
+    */
+    template< int Dim, typename Scalar >
+    inline BoundingBox<Dim, Scalar> boundingBox(ControlPolygonSoAView<Dim, Scalar> polygon)
+    {
+        BoundingBox<Dim, Scalar> box;
+        for (int d = 0; d < Dim; ++d)
+        {
+            auto range = std::minmax_element(polygon.coordinates(d), polygon.coordinates(d) + polygon.size());
+            box.lower[d] = *range.first;
+            box.upper[d] = *range.second;
+        }
+        return box;
+    }
+
+    template< int Dim, typename Scalar >
+    inline BoundingBox<Dim, Scalar> boundingBox(const ControlPolygonSoA<Dim, Scalar> &polygon)
+    {
+        return boundingBox(polygon.view());
+    }
+
+
+    /**
+        @brief The bounding boxes of the [0,t] and [t,1] parts of a curve, read
+        from a complete DeCasteljauScheme filled with parameter t.
+
+        The control points of the [0,t] part are the first points of the
+        columns of the scheme, and those of the [t,1] part the last ones (see
+        split()), so the boxes come for free once the curve has been
+        evaluated at t. They are usually much tighter than the box of the whole
+        curve.
+    */
+    template< typename Point, typename Allocator >
+    inline std::pair<BoundingBoxOf<Point>, BoundingBoxOf<Point>>
+    splitBounds(const DeCasteljauScheme<Point, Allocator> &scheme)
+    {
+        assert( scheme.isComplete() );
+
+        int numPoints = scheme.numPoints();
+
+        std::pair<BoundingBoxOf<Point>, BoundingBoxOf<Point>> result;
+        for (int col = 0; col < numPoints; ++col)
+        {
+            result.first.extend(detail::coordinatesOf(scheme(col, 0)));
+            result.second.extend(detail::coordinatesOf(scheme(col, numPoints - 1 - col)));
+        }
+        return result;
+    }
+
+
+    /**
+        @brief The bounding boxes of a collection of curves, for rejecting
+        curves that miss a query region before doing any de Casteljau work.
+
+        Curves are identified by their index, in the order they are added. The
+        boxes of curves added as a BezierCurve remember the curve's version(),
+        so refresh() recomputes a box only after the curve has changed or
+        another curve has been assigned to it.
+
+        The boxes are stored as one array per corner coordinate, so the
+        filters read them sequentially.
+    */
+    template< int Dim, typename Scalar = float >
+    class BoundingBoxCache
+    {
+    public:
+        typedef BoundingBox<Dim, Scalar> Box;
+
+        /**
+            @brief The number of curves.
+        */
+        int size() const
+        {
+            return mVersions.size();
+        }
+
+        void clear()
+        {
+            for (int d = 0; d < Dim; ++d)
+            {
+                mLower[d].clear();
+                mUpper[d].clear();
+            }
+            mVersions.clear();
+        }
+
+        /**
+            @brief Adds a curve with the given box, returning its index.
+        */
+        int push_back(const Box &box)
+        {
+            for (int d = 0; d < Dim; ++d)
+            {
+                mLower[d].push_back(box.lower[d]);
+                mUpper[d].push_back(box.upper[d]);
+            }
+            mVersions.push_back(NoVersion);
+            return size() - 1;
+        }
+
+        /**
+            @brief Adds the curve with control points `points`.
+        */
+        template< typename Point >
+        int push_back(const std::vector<Point> &points)
+        {
+            return push_back(boundingBox(points));
+        }
+
+        /**
+            @brief Adds `curve`, remembering its version().
+        */
+        template< typename Point, typename ParamScalar >
+        int push_back(const BezierCurve<Point, ParamScalar> &curve)
+        {
+            int curveIdx = push_back(boundingBox(curve.points()));
+            mVersions[curveIdx] = curve.version();
+            return curveIdx;
+        }
+
+        /**
+            @brief Replaces the box of the `curveIdx`th curve.
+        */
+        void set(int curveIdx, const Box &box)
+        {
+            for (int d = 0; d < Dim; ++d)
+            {
+                mLower[d][curveIdx] = box.lower[d];
+                mUpper[d][curveIdx] = box.upper[d];
+            }
+            mVersions[curveIdx] = NoVersion;
+        }
+
+        template< typename Point >
+        void set(int curveIdx, const std::vector<Point> &points)
+        {
+            set(curveIdx, boundingBox(points));
+        }
+
+        /**
+            @brief Recomputes the box of the `curveIdx`th curve from `curve`,
+            unless it was last computed from the same version of it. Returns
+            whether the box was recomputed.
+        */
+        template< typename Point, typename ParamScalar >
+        bool refresh(int curveIdx, const BezierCurve<Point, ParamScalar> &curve)
+        {
+            if (mVersions[curveIdx] == curve.version())
+                return false;
+
+            set(curveIdx, boundingBox(curve.points()));
+            mVersions[curveIdx] = curve.version();
+            return true;
+        }
+
+        Box box(int curveIdx) const
+        {
+            Box result;
+            for (int d = 0; d < Dim; ++d)
+            {
+                result.lower[d] = mLower[d][curveIdx];
+                result.upper[d] = mUpper[d][curveIdx];
+            }
+            return result;
+        }
+
+        /**
+            @brief Writes the indices of the curves whose boxes intersect
+            `query` to `out`, in increasing order. All other curves certainly
+            miss `query`.
+
+            Returns the output iterator one past the last index written.
+        */
+        template< typename OutputIterator >
+        OutputIterator overlapping(const Box &query, OutputIterator out) const
+        {
+            int numCurves = size();
+            for (int curveIdx = 0; curveIdx < numCurves; ++curveIdx)
+            {
+                bool hit = true;
+                for (int d = 0; d < Dim; ++d)
+                    hit &= mLower[d][curveIdx] <= query.upper[d] && query.lower[d] <= mUpper[d][curveIdx];
+
+                if (hit)
+                {
+                    *out = curveIdx;
+                    ++out;
+                }
+            }
+            return out;
+        }
+
+        /**
+            @brief Writes the indices of the curves whose boxes are within
+            `radius` of `p` to `out`, in increasing order, for picking. All
+            other curves are certainly farther than `radius` from `p`.
+        */
+        template< typename OutputIterator >
+        OutputIterator near(const std::array<Scalar, Dim> &p, Scalar radius, OutputIterator out) const
+        {
+            Scalar radiusSquared = radius * radius;
+
+            int numCurves = size();
+            for (int curveIdx = 0; curveIdx < numCurves; ++curveIdx)
+            {
+                Scalar distanceSquared = 0;
+                for (int d = 0; d < Dim; ++d)
+                {
+                    Scalar outside = std::max({ mLower[d][curveIdx] - p[d], Scalar(0), p[d] - mUpper[d][curveIdx] });
+                    distanceSquared += outside * outside;
+                }
+
+                if (distanceSquared <= radiusSquared)
+                {
+                    *out = curveIdx;
+                    ++out;
+                }
+            }
+            return out;
+        }
+
+    private:
+        static constexpr std::uint64_t NoVersion = std::numeric_limits<std::uint64_t>::max();
+
+        std::array<std::vector<Scalar>, Dim> mLower;
+        std::array<std::vector<Scalar>, Dim> mUpper;
+
+        std::vector<std::uint64_t> mVersions;
+    };
+
+}
+
+#endif // BOUNDING_BOX_H
@@ -0,0 +1,172 @@
+#ifndef CACHED_SAMPLE_CURVE_H
+#define CACHED_SAMPLE_CURVE_H
+
+#include <vector>
+#include <iterator>
+#include <cassert>
+
+#include "deCasteljau.h"
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief A Bezier curve together with its points at a fixed set of
+        parameters, which are kept up to date as control points move.
+
+        A point on the curve is linear in each control point: moving b_i to
+        b_i + delta moves the point at t to itself plus B_i(t) delta, where
+        B_i is the i-th Bernstein polynomial of degree n. The values of all
+        Bernstein polynomials at all sample parameters are computed once, so
+        movePoint() costs one multiply-add per sample, instead of a
+        Theta(N^2) de Casteljau scheme per sample.
+
+        Every call to movePoint() adds a rounding error to the samples, so
+        after many moves (for example, at the end of a drag) they should be
+        recomputed from the control points with resync().
+
+        Needs (degree() + 1) * numSamples() scalars for the weights. The
+        following expression must be valid with the Point type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+    */
+    template< typename Point, typename Scalar = float >
+    class CachedSampleCurve
+    {
+    public:
+        CachedSampleCurve(const std::vector<Point> &points, const std::vector<Scalar> &params)
+            : mPoints(points),
+              mParams(params),
+              mWeights(points.size() * params.size())
+        {
+            int degree = points.size() - 1;
+            int numSamples = params.size();
+
+            // The Bernstein polynomials of degree n at t, built up from degree 0
+            // with B_i^k = (1 - t) B_i^(k-1) + t B_(i-1)^(k-1).
+            std::vector<Scalar> basis(degree + 1);
+            for (int k = 0; k < numSamples; ++k)
+            {
+                Scalar t = params[k];
+
+                basis[0] = 1;
+                for (int order = 1; order <= degree; ++order)
+                {
+                    basis[order] = t * basis[order - 1];
+                    for (int i = order - 1; i > 0; --i)
+                        basis[i] = (1 - t) * basis[i] + t * basis[i - 1];
+                    basis[0] = (1 - t) * basis[0];
+                }
+
+                for (int i = 0; i <= degree; ++i)
+                    mWeights[i * numSamples + k] = basis[i];
+            }
+
+            mSamples.reserve(numSamples);
+            resync();
+        }
+
+        /**
+            @brief The degree of the curve.
+        */
+        int degree() const
+        {
+            return mPoints.size() - 1;
+        }
+
+        /**
+            @brief The number of sample parameters.
+        */
+        int numSamples() const
+        {
+            return mParams.size();
+        }
+
+        /**
+            @brief The control points.
+        */
+        const std::vector<Point> &points() const
+        {
+            return mPoints;
+        }
+
+        /**
+            @brief The sample parameters, as given to the constructor.
+        */
+        const std::vector<Scalar> &params() const
+        {
+            return mParams;
+        }
+
+        /**
+            @brief The points of the curve at params(), in the same order.
+        */
+        const std::vector<Point> &samples() const
+        {
+            return mSamples;
+        }
+
+        /**
+            @brief The value of the `pointIdx`th Bernstein polynomial at the
+            `sampleIdx`th parameter, which is how much that sample moves with
+            that control point.
+        */
+        Scalar weight(int pointIdx, int sampleIdx) const
+        {
+            return mWeights[pointIdx * numSamples() + sampleIdx];
+        }
+
+        /**
+            @brief Moves the `pointIdx`th control point to `p` and updates all
+            samples in Theta(numSamples()) time.
+        */
+        void movePoint(int pointIdx, const Point &p)
+        {
+            assert( 0 <= pointIdx && pointIdx <= degree() );
+
+            int count = numSamples();
+            const Scalar *weights = mWeights.data() + pointIdx * count;
+            auto delta = p - mPoints[pointIdx];
+
+            for (int k = 0; k < count; ++k)
+                mSamples[k] = mSamples[k] + weights[k] * delta;
+
+            mPoints[pointIdx] = p;
+        }
+
+        /**
+            @brief Replaces all control points (which must be as many as
+            before) and recomputes the samples.
+        */
+        void setPoints(const std::vector<Point> &points)
+        {
+            assert( points.size() == mPoints.size() );
+
+            mPoints = points;
+            resync();
+        }
+
+        /**
+            @brief Recomputes the samples from the control points with the
+            batched deCasteljau(), discarding the rounding errors accumulated
+            by movePoint().
+        */
+        void resync()
+        {
+            mSamples.clear();
+            deCasteljau(mPoints, mParams.begin(), mParams.end(), std::back_inserter(mSamples));
+        }
+
+    private:
+        std::vector<Point> mPoints;
+        std::vector<Scalar> mParams;
+
+        // mWeights[pointIdx * numSamples() + sampleIdx], so that movePoint()
+        // reads the weights of one control point contiguously.
+        std::vector<Scalar> mWeights;
+
+        std::vector<Point> mSamples;
+    };
+
+}
+
+#endif // CACHED_SAMPLE_CURVE_H
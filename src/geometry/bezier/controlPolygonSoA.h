@@ -0,0 +1,665 @@
+#ifndef CONTROL_POLYGON_SOA_H
+#define CONTROL_POLYGON_SOA_H
+
+#include <array>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <new>
+#include <cstddef>
+#include <cassert>
+
+#include "lanes.h"
+#include "instrumentation.h"
+#include "pointTraits.h"
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief A minimal allocator that returns memory aligned to `Alignment` bytes.
+    */
+    template< typename T, std::size_t Alignment >
+    struct AlignedAllocator
+    {
+        typedef T value_type;
+
+        template< typename U >
+        struct rebind
+        {
+            typedef AlignedAllocator<U, Alignment> other;
+        };
+
+        AlignedAllocator() = default;
+
+        template< typename U >
+        AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+        T *allocate(std::size_t n)
+        {
+            return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+        }
+
+        void deallocate(T *p, std::size_t)
+        {
+            ::operator delete(p, std::align_val_t(Alignment));
+        }
+
+        template< typename U >
+        bool operator==(const AlignedAllocator<U, Alignment> &) const { return true; }
+
+        template< typename U >
+        bool operator!=(const AlignedAllocator<U, Alignment> &) const { return false; }
+    };
+
+
+    /**
+        @brief A read-only view of a structure-of-arrays control polygon in
+        memory owned by someone else, such as a ControlPolygonSoA or a mapped
+        curve-set file (see io/curveSetFile.h).
+
+        The `d`th coordinates of the `size()` points start at
+        `data + d * stride()`. The algorithms below work on views, so they can
+        run on such memory directly.
+    */
+    template< int Dim, typename Scalar = float >
+    class ControlPolygonSoAView
+    {
+    public:
+        typedef Scalar ScalarType;
+
+        static constexpr int Dimension = Dim;
+
+        ControlPolygonSoAView(const Scalar *data, int numPoints, int stride)
+            : mData(data),
+              mNumPoints(numPoints),
+              mStride(stride)
+        {
+        }
+
+        int size() const
+        {
+            return mNumPoints;
+        }
+
+        int stride() const
+        {
+            return mStride;
+        }
+
+        const Scalar *coordinates(int d) const
+        {
+            return mData + d * mStride;
+        }
+
+        const Scalar &operator() (int d, int idx) const
+        {
+            return mData[d * mStride + idx];
+        }
+
+        std::array<Scalar, Dim> point(int idx) const
+        {
+            std::array<Scalar, Dim> p;
+            for (int d = 0; d < Dim; ++d)
+                p[d] = (*this)(d, idx);
+            return p;
+        }
+
+    private:
+        const Scalar *mData;
+        int mNumPoints;
+        int mStride;
+    };
+
+
+    /**
+        @brief A control polygon of `Dim`-dimensional points stored as a
+        structure of arrays.
+
+        Each coordinate is stored in its own contiguous array. All arrays live
+        in one buffer, start on an `Alignment`-byte boundary and are padded with
+        zeros to `stride()` scalars, so that a whole array can be processed with
+        aligned vector loads and stores.
+
+        The overloads of deCasteljau(), blossom() and subdivide() below work on
+        this type (through its view()) and return points as
+        std::array<Scalar, Dim>.
+    */
+    template< int Dim, typename Scalar = float >
+    class ControlPolygonSoA
+    {
+    public:
+        typedef Scalar ScalarType;
+
+        static constexpr int Dimension = Dim;
+        static constexpr std::size_t Alignment = 64;
+
+        explicit ControlPolygonSoA(int numPoints = 0)
+            : mNumPoints(numPoints),
+              mStride(paddedSize(numPoints)),
+              mData(Dim * mStride, Scalar(0))
+        {
+        }
+
+        /**
+            @brief Copies the polygon seen by `view` into a new polygon.
+        */
+        explicit ControlPolygonSoA(ControlPolygonSoAView<Dim, Scalar> view)
+            : ControlPolygonSoA(view.size())
+        {
+            for (int d = 0; d < Dim; ++d)
+                std::copy(view.coordinates(d), view.coordinates(d) + view.size(), coordinates(d));
+        }
+
+        /**
+            @brief Copies `points` into a new polygon. PointTraits<Point> must be
+            specialized and have `Dimension == Dim`.
+        */
+        template< typename Point >
+        static ControlPolygonSoA fromPoints(const std::vector<Point> &points)
+        {
+            static_assert( PointTraits<Point>::Dimension == Dim,
+                           "Point dimension does not match the polygon" );
+
+            ControlPolygonSoA polygon(points.size());
+
+            for (int d = 0; d < Dim; ++d)
+                for (int idx = 0; idx < polygon.size(); ++idx)
+                    polygon(d, idx) = PointTraits<Point>::coordinate(points[idx], d);
+
+            return polygon;
+        }
+
+        /**
+            @brief The number of points in the polygon.
+        */
+        int size() const
+        {
+            return mNumPoints;
+        }
+
+        /**
+            @brief The distance, in scalars, between the starts of two consecutive
+            coordinate arrays. This is at least size().
+        */
+        int stride() const
+        {
+            return mStride;
+        }
+
+        /**
+            @brief The contiguous array of the `d`th coordinates of all points.
+        */
+        Scalar *coordinates(int d)
+        {
+            return mData.data() + d * mStride;
+        }
+
+        const Scalar *coordinates(int d) const
+        {
+            return mData.data() + d * mStride;
+        }
+
+        /**
+            @brief Accesses the `d`th coordinate of the `idx`th point.
+        */
+        Scalar &operator() (int d, int idx)
+        {
+            return mData[d * mStride + idx];
+        }
+
+        const Scalar &operator() (int d, int idx) const
+        {
+            return mData[d * mStride + idx];
+        }
+
+        /**
+            @brief Gathers the coordinates of the `idx`th point.
+        */
+        std::array<Scalar, Dim> point(int idx) const
+        {
+            std::array<Scalar, Dim> p;
+            for (int d = 0; d < Dim; ++d)
+                p[d] = (*this)(d, idx);
+            return p;
+        }
+
+        /**
+            @brief Changes the number of points. All coordinates become zero.
+            Memory is kept, so shrinking does not allocate.
+        */
+        void resize(int numPoints)
+        {
+            mNumPoints = numPoints;
+            mStride = paddedSize(numPoints);
+            mData.assign(Dim * mStride, Scalar(0));
+        }
+
+        /**
+            @brief A read-only view of this polygon.
+        */
+        ControlPolygonSoAView<Dim, Scalar> view() const
+        {
+            return ControlPolygonSoAView<Dim, Scalar>(mData.data(), mNumPoints, mStride);
+        }
+
+        /**
+            @brief Rounds `numPoints` up to a whole number of aligned blocks.
+        */
+        static int paddedSize(int numPoints)
+        {
+            const int block = Alignment / sizeof(Scalar);
+            return ((numPoints + block - 1) / block) * block;
+        }
+
+    private:
+        int mNumPoints;
+        int mStride;
+        std::vector<Scalar, AlignedAllocator<Scalar, Alignment>> mData;
+    };
+
+
+    /**
+        @brief Caller-owned scratch memory for the workspace overloads of the
+        structure-of-arrays deCasteljau(), blossom() and subdivide() below.
+
+        Like DeCasteljauWorkspace in deCasteljau.h, it grows to fit the largest
+        polygon (and SIMD batch) it has been used with and keeps that memory,
+        so once it has warmed up, evaluating through it does not allocate. A
+        workspace must not be shared between threads.
+    */
+    template< typename Scalar = float >
+    class ControlPolygonSoAWorkspace
+    {
+    public:
+        /**
+            @brief Returns room for at least `size` scalars.
+        */
+        Scalar *scratch(int size)
+        {
+            if (int(mScratch.size()) < size)
+            {
+                mScratch.resize(size);
+                CAGD_BEZIER_COUNT_ALLOCATION(sizeof(Scalar) * mScratch.size());
+            }
+
+            return mScratch.data();
+        }
+
+    private:
+        std::vector<Scalar> mScratch;
+    };
+
+
+    namespace detail
+    {
+
+        /**
+            @brief The largest polygon that the overloads below without a
+            workspace evaluate with scratch memory on the stack. Larger ones
+            allocate once per call.
+        */
+        constexpr int MaxStackPoints = 64;
+
+        /**
+            @brief The de Casteljau algorithm on one coordinate array. `scratch`
+            must have room for `numPoints` scalars.
+        */
+        template< typename Scalar >
+        inline Scalar deCasteljauRow(const Scalar *row, int numPoints, Scalar t, Scalar *scratch)
+        {
+            for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+                scratch[pointIdx] = row[pointIdx];
+
+            for (int iteration = 1; iteration < numPoints; ++iteration)
+                for (int pointIdx = 0; pointIdx < numPoints - iteration; ++pointIdx)
+                    scratch[pointIdx] = scratch[pointIdx] + t * (scratch[pointIdx + 1] - scratch[pointIdx]);
+
+            return scratch[0];
+        }
+
+        /**
+            @brief The blossom algorithm on one coordinate array. `params` holds
+            `numPoints - 1` scalars and `scratch` must have room for `numPoints`.
+        */
+        template< typename Scalar >
+        inline Scalar blossomRow(const Scalar *row, int numPoints, const Scalar *params, Scalar *scratch)
+        {
+            for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+                scratch[pointIdx] = row[pointIdx];
+
+            for (int iteration = 1; iteration < numPoints; ++iteration)
+                for (int pointIdx = 0; pointIdx < numPoints - iteration; ++pointIdx)
+                    scratch[pointIdx] = scratch[pointIdx] + params[iteration - 1] * (scratch[pointIdx + 1] - scratch[pointIdx]);
+
+            return scratch[0];
+        }
+
+        /**
+            @brief The vector-returning subdivide() on one coordinate array,
+            writing `numPoints` scalars to `out`. `scheme` must have room for the
+            whole de Casteljau scheme, `numPoints * (numPoints + 1) / 2` scalars,
+            which is laid out like DeCasteljauScheme.
+        */
+        template< typename Scalar >
+        inline void subdivideRow(const Scalar *row, int numPoints, Scalar t0, Scalar t1,
+                                 Scalar *out, Scalar *scheme)
+        {
+            auto column = [numPoints, scheme] (int col) {
+                return scheme + ((2 * numPoints - col + 1) * col) / 2;
+            };
+
+            for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+                scheme[pointIdx] = row[pointIdx];
+
+            for (int iterationIdx = 1; iterationIdx < numPoints; ++iterationIdx)
+            {
+                const Scalar *prev = column(iterationIdx - 1);
+                Scalar *next = column(iterationIdx);
+
+                for (int pointIdx = 0; pointIdx < numPoints - iterationIdx; ++pointIdx)
+                    next[pointIdx] = prev[pointIdx] + t0 * (prev[pointIdx + 1] - prev[pointIdx]);
+            }
+
+            out[0] = column(numPoints - 1)[0];
+
+            for (int newPointIdx = 1; newPointIdx < numPoints; ++newPointIdx)
+            {
+                for (int iterationIdx = numPoints - newPointIdx; iterationIdx < numPoints; ++iterationIdx)
+                {
+                    const Scalar *prev = column(iterationIdx - 1);
+                    Scalar *next = column(iterationIdx);
+
+                    for (int pointIdx = 0; pointIdx < numPoints - iterationIdx; ++pointIdx)
+                        next[pointIdx] = prev[pointIdx] + t1 * (prev[pointIdx + 1] - prev[pointIdx]);
+                }
+
+                out[newPointIdx] = column(numPoints - 1)[0];
+            }
+        }
+
+    }
+
+
+    /**
+        @brief Performs the de Casteljau algorithm with parameter t on a
+        structure-of-arrays polygon, one coordinate array at a time, using the
+        scratch memory of `workspace`.
+    */
+    template< int Dim, typename Scalar >
+    inline std::array<Scalar, Dim> deCasteljau(ControlPolygonSoAView<Dim, Scalar> polygon,
+                                               detail::NonDeduced<Scalar> t,
+                                               ControlPolygonSoAWorkspace<Scalar> &workspace)
+    {
+        CAGD_BEZIER_INSTRUMENT(DeCasteljau, polygon.size() - 1);
+
+        Scalar *scratch = workspace.scratch(polygon.size());
+        std::array<Scalar, Dim> result;
+
+        for (int d = 0; d < Dim; ++d)
+            result[d] = detail::deCasteljauRow(polygon.coordinates(d), polygon.size(), t, scratch);
+
+        return result;
+    }
+
+    /**
+        @brief The de Casteljau algorithm above with scratch memory on the stack
+        for polygons of up to detail::MaxStackPoints points, so that evaluating
+        curves of such degrees does not allocate.
+    */
+    template< int Dim, typename Scalar >
+    inline std::array<Scalar, Dim> deCasteljau(ControlPolygonSoAView<Dim, Scalar> polygon,
+                                               detail::NonDeduced<Scalar> t)
+    {
+        if (polygon.size() > detail::MaxStackPoints)
+        {
+            ControlPolygonSoAWorkspace<Scalar> workspace;
+            return deCasteljau(polygon, t, workspace);
+        }
+
+        CAGD_BEZIER_INSTRUMENT(DeCasteljau, polygon.size() - 1);
+
+        Scalar scratch[detail::MaxStackPoints];
+        std::array<Scalar, Dim> result;
+
+        for (int d = 0; d < Dim; ++d)
+            result[d] = detail::deCasteljauRow(polygon.coordinates(d), polygon.size(), t, scratch);
+
+        return result;
+    }
+
+    template< int Dim, typename Scalar >
+    inline std::array<Scalar, Dim> deCasteljau(const ControlPolygonSoA<Dim, Scalar> &polygon,
+                                               detail::NonDeduced<Scalar> t)
+    {
+        return deCasteljau(polygon.view(), t);
+    }
+
+
+    /**
+        @brief Performs the de Casteljau algorithm once for every parameter in
+        [firstParam, lastParam) on a structure-of-arrays polygon, writing one
+        std::array<Scalar, Dim> per parameter to `out`.
+
+        Parameters are evaluated several at a time in SIMD lanes (see lanes.h),
+        one coordinate array at a time, in the scratch memory of `workspace`.
+
+        Returns the output iterator one past the last point written.
+    */
+    template< int Dim, typename Scalar, typename ParamIterator, typename OutputIterator >
+    inline OutputIterator deCasteljau(ControlPolygonSoAView<Dim, Scalar> polygon,
+                                      ParamIterator firstParam, ParamIterator lastParam,
+                                      OutputIterator out, ControlPolygonSoAWorkspace<Scalar> &workspace)
+    {
+        CAGD_BEZIER_INSTRUMENT(DeCasteljauBatch, polygon.size() - 1);
+
+        int numPoints = polygon.size();
+        int lanes = detail::laneCount();
+
+        Scalar *scratch = workspace.scratch(numPoints * lanes);
+        Scalar params[detail::MaxLanes];
+        std::array<Scalar, Dim> results[detail::MaxLanes];
+
+        while (firstParam != lastParam)
+        {
+            int count = 0;
+            for (; count < lanes && firstParam != lastParam; ++count, ++firstParam)
+                params[count] = *firstParam;
+
+            for (int lane = count; lane < lanes; ++lane)
+                params[lane] = params[count - 1];
+
+            for (int d = 0; d < Dim; ++d)
+            {
+                const Scalar *row = polygon.coordinates(d);
+
+                for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+                    for (int lane = 0; lane < lanes; ++lane)
+                        scratch[pointIdx * lanes + lane] = row[pointIdx];
+
+                detail::runLanes(numPoints, params, 0, scratch);
+
+                for (int lane = 0; lane < count; ++lane)
+                    results[lane][d] = scratch[lane];
+            }
+
+            for (int lane = 0; lane < count; ++lane)
+            {
+                *out = results[lane];
+                ++out;
+            }
+        }
+
+        return out;
+    }
+
+    /**
+        @brief The batched de Casteljau algorithm above with a scratch buffer
+        allocated once for the whole batch.
+    */
+    template< int Dim, typename Scalar, typename ParamIterator, typename OutputIterator >
+    inline OutputIterator deCasteljau(ControlPolygonSoAView<Dim, Scalar> polygon,
+                                      ParamIterator firstParam, ParamIterator lastParam,
+                                      OutputIterator out)
+    {
+        ControlPolygonSoAWorkspace<Scalar> workspace;
+        return deCasteljau(polygon, firstParam, lastParam, out, workspace);
+    }
+
+    template< int Dim, typename Scalar, typename ParamIterator, typename OutputIterator >
+    inline OutputIterator deCasteljau(const ControlPolygonSoA<Dim, Scalar> &polygon,
+                                      ParamIterator firstParam, ParamIterator lastParam,
+                                      OutputIterator out)
+    {
+        return deCasteljau(polygon.view(), firstParam, lastParam, out);
+    }
+
+
+    /**
+        @brief Computes the blossom of a structure-of-arrays polygon using the
+        scratch memory of `workspace`. params.size() must be equal to
+        polygon.size() - 1.
+    */
+    template< int Dim, typename Scalar >
+    inline std::array<Scalar, Dim> blossom(ControlPolygonSoAView<Dim, Scalar> polygon,
+                                           const std::vector<detail::NonDeduced<Scalar>> &params,
+                                           ControlPolygonSoAWorkspace<Scalar> &workspace)
+    {
+        assert( int(params.size()) == polygon.size() - 1 );
+
+        CAGD_BEZIER_INSTRUMENT(Blossom, polygon.size() - 1);
+
+        Scalar *scratch = workspace.scratch(polygon.size());
+        std::array<Scalar, Dim> result;
+
+        for (int d = 0; d < Dim; ++d)
+            result[d] = detail::blossomRow(polygon.coordinates(d), polygon.size(), params.data(), scratch);
+
+        return result;
+    }
+
+    /**
+        @brief The blossom above with scratch memory on the stack for polygons
+        of up to detail::MaxStackPoints points.
+    */
+    template< int Dim, typename Scalar >
+    inline std::array<Scalar, Dim> blossom(ControlPolygonSoAView<Dim, Scalar> polygon,
+                                           const std::vector<detail::NonDeduced<Scalar>> &params)
+    {
+        assert( int(params.size()) == polygon.size() - 1 );
+
+        if (polygon.size() > detail::MaxStackPoints)
+        {
+            ControlPolygonSoAWorkspace<Scalar> workspace;
+            return blossom(polygon, params, workspace);
+        }
+
+        CAGD_BEZIER_INSTRUMENT(Blossom, polygon.size() - 1);
+
+        Scalar scratch[detail::MaxStackPoints];
+        std::array<Scalar, Dim> result;
+
+        for (int d = 0; d < Dim; ++d)
+            result[d] = detail::blossomRow(polygon.coordinates(d), polygon.size(), params.data(), scratch);
+
+        return result;
+    }
+
+    template< int Dim, typename Scalar >
+    inline std::array<Scalar, Dim> blossom(const ControlPolygonSoA<Dim, Scalar> &polygon,
+                                           const std::vector<detail::NonDeduced<Scalar>> &params)
+    {
+        return blossom(polygon.view(), params);
+    }
+
+
+    /**
+        @brief Finds the structure-of-arrays polygon that maps [0,1] to the
+        [t0,t1] part of `polygon`'s curve and writes it to `result`, reusing
+        its memory. This is the same as the vector-returning subdivide() in
+        deCasteljau.h, applied to each coordinate array in turn with one
+        scheme buffer from `workspace`.
+    */
+    template< int Dim, typename Scalar >
+    inline void subdivide(ControlPolygonSoAView<Dim, Scalar> polygon,
+                          detail::NonDeduced<Scalar> t0, detail::NonDeduced<Scalar> t1,
+                          ControlPolygonSoAWorkspace<Scalar> &workspace, ControlPolygonSoA<Dim, Scalar> &result)
+    {
+        int numPoints = polygon.size();
+
+        CAGD_BEZIER_INSTRUMENT(Subdivide, numPoints - 1);
+
+        result.resize(numPoints);
+        Scalar *scheme = workspace.scratch((numPoints * (numPoints + 1)) / 2);
+
+        for (int d = 0; d < Dim; ++d)
+            detail::subdivideRow(polygon.coordinates(d), numPoints, t0, t1, result.coordinates(d), scheme);
+    }
+
+    /**
+        @brief The subdivide() above, returning a new polygon. The scheme
+        buffer is allocated once per call.
+    */
+    template< int Dim, typename Scalar >
+    inline ControlPolygonSoA<Dim, Scalar> subdivide(ControlPolygonSoAView<Dim, Scalar> polygon,
+                                                   detail::NonDeduced<Scalar> t0,
+                                                   detail::NonDeduced<Scalar> t1)
+    {
+        ControlPolygonSoAWorkspace<Scalar> workspace;
+        ControlPolygonSoA<Dim, Scalar> result;
+        subdivide(polygon, t0, t1, workspace, result);
+
+        return result;
+    }
+
+    template< int Dim, typename Scalar >
+    inline ControlPolygonSoA<Dim, Scalar> subdivide(const ControlPolygonSoA<Dim, Scalar> &polygon,
+                                                   detail::NonDeduced<Scalar> t0,
+                                                   detail::NonDeduced<Scalar> t1)
+    {
+        return subdivide(polygon.view(), t0, t1);
+    }
+
+
+    /**
+        @brief Splits the curve of a structure-of-arrays polygon at parameter t
+        in a single pass per coordinate array, like split() in deCasteljau.h.
+        Returns the polygons of the [0,t] and [t,1] parts of the curve.
+    */
+    template< int Dim, typename Scalar >
+    inline std::pair<ControlPolygonSoA<Dim, Scalar>, ControlPolygonSoA<Dim, Scalar>>
+    split(ControlPolygonSoAView<Dim, Scalar> polygon, detail::NonDeduced<Scalar> t)
+    {
+        int numPoints = polygon.size();
+
+        CAGD_BEZIER_INSTRUMENT(Split, numPoints - 1);
+
+        std::pair<ControlPolygonSoA<Dim, Scalar>, ControlPolygonSoA<Dim, Scalar>> halves(polygon, polygon);
+
+        for (int d = 0; d < Dim; ++d)
+        {
+            Scalar *left = halves.first.coordinates(d);
+            Scalar *right = halves.second.coordinates(d);
+
+            for (int iteration = 1; iteration < numPoints; ++iteration)
+            {
+                for (int pointIdx = 0; pointIdx < numPoints - iteration; ++pointIdx)
+                    right[pointIdx] = right[pointIdx] + t * (right[pointIdx + 1] - right[pointIdx]);
+
+                left[iteration] = right[0];
+            }
+        }
+
+        return halves;
+    }
+
+    template< int Dim, typename Scalar >
+    inline std::pair<ControlPolygonSoA<Dim, Scalar>, ControlPolygonSoA<Dim, Scalar>>
+    split(const ControlPolygonSoA<Dim, Scalar> &polygon, detail::NonDeduced<Scalar> t)
+    {
+        return split(polygon.view(), t);
+    }
+
+}
+
+#endif // CONTROL_POLYGON_SOA_H
@@ -0,0 +1,431 @@
+#ifndef CURVE_BVH_H
+#define CURVE_BVH_H
+
+#include <array>
+#include <vector>
+#include <optional>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+
+#include "deCasteljau.h"
+#include "adaptiveTessellation.h"
+#include "boundingBox.h"
+#include "pointTraits.h"
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief The result of a CurveBVH closest-point query: the `curve`th
+        curve passes through `point` at parameter `t`, at `distance` from the
+        query point.
+    */
+    template< typename Point, typename Scalar >
+    struct CurveHit
+    {
+        int curve;
+        Scalar t;
+        Point point;
+        typename PointTraits<Point>::Scalar distance;
+    };
+
+
+    /**
+        @brief A bounding volume hierarchy over a set of curves, for picking,
+        box queries and closest-point queries that take time logarithmic in the
+        number of curves instead of scanning all of them.
+
+        Every curve is split in half with split() until the control polygon
+        of each piece is within `tolerance` of a straight line (see flatness())
+        or the piece has been split `maxDepth` times. The pieces are the leaves
+        of a binary tree of bounding boxes, built top-down by splitting the
+        pieces at the median of their box centers along the axis on which those
+        centers are spread the most. By the convex hull property, every piece
+        lies in its box, so a subtree whose box misses a query is skipped.
+
+        When control points move, setCurve() recomputes the pieces of one curve
+        for the parameter ranges they had before and refits the boxes on their
+        paths to the root, which keeps queries correct. The tree itself is not
+        rebuilt, so after large changes its boxes may overlap more than
+        necessary, and the pieces may no longer be flat; building a new
+        hierarchy restores both.
+
+        PointTraits<Point> must be specialized, and the following expression
+        must be valid with the Point type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+    */
+    template< typename Point, typename Scalar = float >
+    class CurveBVH
+    {
+        typedef PointTraits<Point> Traits;
+
+    public:
+        typedef typename Traits::Scalar Coordinate;
+        typedef BoundingBoxOf<Point> Box;
+        typedef CurveHit<Point, Scalar> Hit;
+
+        /**
+            @brief Builds the hierarchy over `curves`, with at most `leafSize`
+            pieces per leaf.
+        */
+        CurveBVH(const std::vector<std::vector<Point>> &curves, Coordinate tolerance,
+                 int maxDepth = 8, int leafSize = 4)
+            : mCurves(curves),
+              mLeafSize(leafSize)
+        {
+            assert( leafSize >= 1 );
+
+            int numCurves = curves.size();
+            mFirstPiece.reserve(numCurves + 1);
+
+            for (int curveIdx = 0; curveIdx < numCurves; ++curveIdx)
+            {
+                mFirstPiece.push_back(mPieces.size());
+                addPieces(curveIdx, curves[curveIdx], 0, 1, tolerance, maxDepth);
+            }
+            mFirstPiece.push_back(mPieces.size());
+
+            int numPieces = mPieces.size();
+            if (numPieces == 0)
+                return;
+
+            mOrder.resize(numPieces);
+            for (int pieceIdx = 0; pieceIdx < numPieces; ++pieceIdx)
+                mOrder[pieceIdx] = pieceIdx;
+            mLeafOf.resize(numPieces);
+
+            // A binary tree with at most numPieces leaves has fewer than twice
+            // as many nodes, so the vector is never reallocated while building.
+            mNodes.reserve(2 * numPieces);
+            mNodes.push_back(Node());
+            build(0, 0, numPieces);
+        }
+
+        int numCurves() const
+        {
+            return mCurves.size();
+        }
+
+        /**
+            @brief The number of pieces the curves were split into.
+        */
+        int numPieces() const
+        {
+            return mPieces.size();
+        }
+
+        /**
+            @brief The control points of the `curveIdx`th curve.
+        */
+        const std::vector<Point> &curve(int curveIdx) const
+        {
+            return mCurves[curveIdx];
+        }
+
+        /**
+            @brief The box of all curves.
+        */
+        Box bounds() const
+        {
+            return mNodes.empty() ? Box() : mNodes[0].box;
+        }
+
+        /**
+            @brief Replaces the control points of the `curveIdx`th curve by
+            `points`, which must be as many as before, and refits the
+            hierarchy.
+        */
+        void setCurve(int curveIdx, const std::vector<Point> &points)
+        {
+            assert( points.size() == mCurves[curveIdx].size() );
+
+            mCurves[curveIdx] = points;
+
+            DeCasteljauWorkspace<Point> workspace;
+            std::vector<Point> piecePoints;
+
+            for (int pieceIdx = mFirstPiece[curveIdx]; pieceIdx < mFirstPiece[curveIdx + 1]; ++pieceIdx)
+            {
+                Piece &piece = mPieces[pieceIdx];
+
+                subdivide<Scalar>(points, piece.t0, piece.t1, workspace, piecePoints);
+                std::copy(piecePoints.begin(), piecePoints.end(), mPiecePoints.begin() + piece.firstPoint);
+                piece.box = boundingBox(piecePoints);
+            }
+
+            for (int pieceIdx = mFirstPiece[curveIdx]; pieceIdx < mFirstPiece[curveIdx + 1]; ++pieceIdx)
+                refit(mLeafOf[pieceIdx]);
+        }
+
+        /**
+            @brief Writes the indices of the curves that may intersect `region`
+            to `out`, each once and in increasing order. Curves that are not
+            written certainly miss `region`.
+
+            Returns the output iterator one past the last index written.
+        */
+        template< typename OutputIterator >
+        OutputIterator query(const Box &region, OutputIterator out) const
+        {
+            std::vector<int> curves;
+            std::vector<int> stack;
+
+            if (!mNodes.empty())
+                stack.push_back(0);
+
+            while (!stack.empty())
+            {
+                const Node &node = mNodes[stack.back()];
+                stack.pop_back();
+
+                if (!node.box.intersects(region))
+                    continue;
+
+                if (node.count == 0)
+                {
+                    stack.push_back(node.first);
+                    stack.push_back(node.first + 1);
+                    continue;
+                }
+
+                for (int k = node.first; k < node.first + node.count; ++k)
+                    if (mPieces[mOrder[k]].box.intersects(region))
+                        curves.push_back(mPieces[mOrder[k]].curve);
+            }
+
+            std::sort(curves.begin(), curves.end());
+            return std::unique_copy(curves.begin(), curves.end(), out);
+        }
+
+        /**
+            @brief Finds the point of the curves closest to `p`, if there is one
+            within `maxDistance`.
+
+            Within a piece, the parameter is found by projecting `p` onto the
+            chord of the piece's control polygon and the point is then
+            evaluated exactly, so the distance found exceeds the true distance
+            to the nearest curve by at most about twice the tolerance the
+            hierarchy was built with.
+        */
+        std::optional<Hit> closest(const Point &p,
+                                   Coordinate maxDistance = std::numeric_limits<Coordinate>::infinity()) const
+        {
+            std::array<Coordinate, Traits::Dimension> q = detail::coordinatesOf(p);
+
+            std::optional<Hit> best;
+            Coordinate bestSquared = maxDistance * maxDistance;
+
+            DeCasteljauWorkspace<Point> workspace;
+            std::vector<int> stack;
+
+            if (!mNodes.empty())
+                stack.push_back(0);
+
+            while (!stack.empty())
+            {
+                const Node &node = mNodes[stack.back()];
+                stack.pop_back();
+
+                if (node.box.distanceSquared(q) > bestSquared)
+                    continue;
+
+                if (node.count == 0)
+                {
+                    // Visit the nearer child first, so that it tightens the
+                    // bound before the farther one is tested.
+                    int nearer = node.first, farther = node.first + 1;
+                    if (mNodes[farther].box.distanceSquared(q) < mNodes[nearer].box.distanceSquared(q))
+                        std::swap(nearer, farther);
+
+                    stack.push_back(farther);
+                    stack.push_back(nearer);
+                    continue;
+                }
+
+                for (int k = node.first; k < node.first + node.count; ++k)
+                {
+                    const Piece &piece = mPieces[mOrder[k]];
+                    if (piece.box.distanceSquared(q) > bestSquared)
+                        continue;
+
+                    Scalar s = chordParameter(piece, q);
+                    const Point *first = mPiecePoints.data() + piece.firstPoint;
+                    int numPoints = mCurves[piece.curve].size();
+
+                    Point onCurve = deCasteljau<Scalar>(workspace.load(first, first + numPoints), numPoints, s);
+                    Coordinate distanceSquared = detail::distanceSquared(q, detail::coordinatesOf(onCurve));
+
+                    if (distanceSquared <= bestSquared)
+                    {
+                        bestSquared = distanceSquared;
+                        best = Hit { piece.curve, piece.t0 + s * (piece.t1 - piece.t0),
+                                     onCurve, std::sqrt(distanceSquared) };
+                    }
+                }
+            }
+
+            return best;
+        }
+
+        /**
+            @brief Finds the point of the curves closest to `p` as closest()
+            does, if it is within `radius` of `p`, as when picking with the
+            mouse.
+        */
+        std::optional<Hit> pick(const Point &p, Coordinate radius) const
+        {
+            return closest(p, radius);
+        }
+
+    private:
+        struct Piece
+        {
+            int curve;
+            Scalar t0, t1;
+            int firstPoint;
+            Box box;
+        };
+
+        // A leaf has count > 0 pieces, mOrder[first] onwards. An inner node
+        // has count == 0 and the children first and first + 1.
+        struct Node
+        {
+            Box box;
+            int first = 0;
+            int count = 0;
+            int parent = -1;
+        };
+
+        void addPieces(int curveIdx, std::vector<Point> points, Scalar t0, Scalar t1,
+                       Coordinate tolerance, int depth)
+        {
+            int numPoints = points.size();
+
+            if (depth == 0 || numPoints < 3 || flatness(points.data(), numPoints) <= tolerance)
+            {
+                mPieces.push_back(Piece { curveIdx, t0, t1, int(mPiecePoints.size()), boundingBox(points) });
+                mPiecePoints.insert(mPiecePoints.end(), points.begin(), points.end());
+                return;
+            }
+
+            std::vector<Point> left(points);
+            split<Scalar>(points.data(), numPoints, 0.5, left.data());
+
+            Scalar middle = (t0 + t1) / 2;
+            addPieces(curveIdx, std::move(left), t0, middle, tolerance, depth - 1);
+            addPieces(curveIdx, std::move(points), middle, t1, tolerance, depth - 1);
+        }
+
+        void build(int nodeIdx, int first, int count)
+        {
+            Box box, centers;
+            for (int k = first; k < first + count; ++k)
+            {
+                const Box &pieceBox = mPieces[mOrder[k]].box;
+                box.extend(pieceBox);
+                centers.extend(center(pieceBox));
+            }
+
+            mNodes[nodeIdx].box = box;
+
+            if (count <= mLeafSize)
+            {
+                mNodes[nodeIdx].first = first;
+                mNodes[nodeIdx].count = count;
+                for (int k = first; k < first + count; ++k)
+                    mLeafOf[mOrder[k]] = nodeIdx;
+                return;
+            }
+
+            int axis = 0;
+            for (int d = 1; d < Traits::Dimension; ++d)
+                if (centers.upper[d] - centers.lower[d] > centers.upper[axis] - centers.lower[axis])
+                    axis = d;
+
+            int middle = first + count / 2;
+            std::nth_element(mOrder.begin() + first, mOrder.begin() + middle, mOrder.begin() + first + count,
+                             [&] (int a, int b) {
+                                 return center(mPieces[a].box)[axis] < center(mPieces[b].box)[axis];
+                             });
+
+            int child = mNodes.size();
+            mNodes.resize(child + 2);
+            mNodes[nodeIdx].first = child;
+            mNodes[child].parent = mNodes[child + 1].parent = nodeIdx;
+
+            build(child, first, middle - first);
+            build(child + 1, middle, first + count - middle);
+        }
+
+        /**
+            @brief Recomputes the box of a leaf from its pieces, and the boxes
+            of its ancestors from their children.
+        */
+        void refit(int leafIdx)
+        {
+            Node &leaf = mNodes[leafIdx];
+            leaf.box = Box();
+            for (int k = leaf.first; k < leaf.first + leaf.count; ++k)
+                leaf.box.extend(mPieces[mOrder[k]].box);
+
+            for (int nodeIdx = leaf.parent; nodeIdx >= 0; nodeIdx = mNodes[nodeIdx].parent)
+            {
+                Node &node = mNodes[nodeIdx];
+                node.box = mNodes[node.first].box;
+                node.box.extend(mNodes[node.first + 1].box);
+            }
+        }
+
+        static std::array<Coordinate, Traits::Dimension> center(const Box &box)
+        {
+            std::array<Coordinate, Traits::Dimension> result;
+            for (int d = 0; d < Traits::Dimension; ++d)
+                result[d] = (box.lower[d] + box.upper[d]) / 2;
+            return result;
+        }
+
+        /**
+            @brief The parameter in [0,1] of the point of the chord of `piece`
+            closest to `q`.
+        */
+        Scalar chordParameter(const Piece &piece, const std::array<Coordinate, Traits::Dimension> &q) const
+        {
+            int numPoints = mCurves[piece.curve].size();
+            auto first = detail::coordinatesOf(mPiecePoints[piece.firstPoint]);
+            auto last = detail::coordinatesOf(mPiecePoints[piece.firstPoint + numPoints - 1]);
+
+            Coordinate along = 0, lengthSquared = 0;
+            for (int d = 0; d < Traits::Dimension; ++d)
+            {
+                along += (q[d] - first[d]) * (last[d] - first[d]);
+                lengthSquared += (last[d] - first[d]) * (last[d] - first[d]);
+            }
+
+            if (lengthSquared == 0)
+                return 0;
+
+            return std::clamp(Scalar(along / lengthSquared), Scalar(0), Scalar(1));
+        }
+
+        std::vector<std::vector<Point>> mCurves;
+        int mLeafSize;
+
+        // The pieces of curve c are mPieces[mFirstPiece[c]] up to
+        // mPieces[mFirstPiece[c + 1]], and their control points are stored
+        // one after the other in mPiecePoints.
+        std::vector<Piece> mPieces;
+        std::vector<Point> mPiecePoints;
+        std::vector<int> mFirstPiece;
+
+        // The pieces in the order of the leaves, and the leaf of every piece.
+        std::vector<int> mOrder;
+        std::vector<int> mLeafOf;
+
+        std::vector<Node> mNodes;
+    };
+
+}
+
+#endif // CURVE_BVH_H
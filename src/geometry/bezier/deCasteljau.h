@@ -2,23 +2,114 @@
 #define DE_CASTELJAU_H
 
 #include <vector>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <memory_resource>
+#include <optional>
+#include <cstddef>
 #include <cassert>
 
+#include "lanes.h"
+#include "instrumentation.h"
+#include "pointTraits.h"
+
 namespace Geometry::Bezier
 {
 
+    /*
+        Every algorithm in this header takes its parameters as `Scalar`, which
+        is float unless it is given as the first template argument:
+            deCasteljau<double>(points, t)
+        The parameters are passed on to the Point type's operators as they are,
+        so <Scalar> * (<Point> - <Point>) must be valid, and the precision of
+        the arithmetic is whatever the Point type makes of it. Batched versions
+        take their Scalar from the value type of the parameter iterators.
+
+        For polygons of high degree or parameters far outside [0,1], see also
+        compensatedDeCasteljau() in compensatedDeCasteljau.h.
+    */
+
     /**
         @brief Stores all columns of a de Casteljau scheme contiguously.
+
+        A scheme can be reused for different polygons with reset(), which keeps
+        the memory it has. Through fill(), setPoint() and subdivide() it also
+        serves as a cache: after a change to one control point or to the end
+        of the subdivided interval, only the part of the triangle that depends
+        on the change is recomputed.
+
+        The storage for the scheme is obtained from `Allocator`; see
+        DeCasteljauWorkspace::schemeAllocator() for an arena-backed one.
     */
-    template< typename Point >
+    template< typename Point, typename Allocator = std::allocator<Point> >
     class DeCasteljauScheme
     {
     public:
-        DeCasteljauScheme(std::vector<Point> initialPoints)
-            : mNumPoints(initialPoints.size())
+        DeCasteljauScheme(const std::vector<Point> &initialPoints,
+                          const Allocator &allocator = Allocator())
+            : mNumPoints(initialPoints.size()),
+              mScheme(allocator),
+              mRow(allocator)
+        {
+            reserve(mNumPoints);
+            mScheme.assign(initialPoints.begin(), initialPoints.end());
+        }
+
+        /**
+            @brief Starts a scheme with the points in [first, last) as its
+            first column.
+        */
+        template< typename RandomAccessIterator >
+        DeCasteljauScheme(RandomAccessIterator first, RandomAccessIterator last,
+                          const Allocator &allocator = Allocator())
+            : mNumPoints(last - first),
+              mScheme(allocator),
+              mRow(allocator)
+        {
+            reserve(mNumPoints);
+            mScheme.assign(first, last);
+        }
+
+        /**
+            @brief Starts over with `initialPoints` as the first column, which
+            may have a different number of points than before. Memory is kept,
+            so resetting to a polygon that is not larger does not allocate.
+        */
+        void reset(const std::vector<Point> &initialPoints)
+        {
+            reset(initialPoints.begin(), initialPoints.end());
+        }
+
+        /**
+            @brief Starts over with the points in [first, last) as the first
+            column, like reset() above.
+        */
+        template< typename RandomAccessIterator >
+        void reset(RandomAccessIterator first, RandomAccessIterator last)
+        {
+            mNumPoints = last - first;
+
+            mScheme.clear();
+            reserve(mNumPoints);
+            mScheme.assign(first, last);
+        }
+
+        /**
+            @brief The number of points in the first column.
+        */
+        int numPoints() const
+        {
+            return mNumPoints;
+        }
+
+        /**
+            @brief True if every point of the scheme has been computed (with
+            fill(), or by push_back()).
+        */
+        bool isComplete() const
         {
-            mScheme.reserve((mNumPoints * (mNumPoints + 1)) / 2);
-            mScheme = initialPoints;
+            return int(mScheme.size()) == size(mNumPoints);
         }
 
         /**
@@ -76,62 +167,629 @@ namespace Geometry::Bezier
         {
             mScheme.push_back(p);
         }
+
+        /**
+            @brief Computes all columns with parameter t, replacing any columns
+            but the first, and returns the last point (the point of the curve
+            at t).
+
+            The following expression must be valid with the Point type:
+                <Point> + <Scalar> * (<Point> - <Point>)
+        */
+        template< typename Scalar = float >
+        const Point &fill(detail::NonDeduced<Scalar> t)
+        {
+            mScheme.erase(mScheme.begin() + mNumPoints, mScheme.end());
+
+            for (int col = 1; col < mNumPoints; ++col)
+                for (int idx = 0; idx < mNumPoints - col; ++idx)
+                {
+                    const Point &p1 = (*this)(col - 1, idx);
+                    const Point &p2 = (*this)(col - 1, idx + 1);
+                    push_back(p1 + t * (p2 - p1));
+                }
+
+            return last();
+        }
+
+        /**
+            @brief Replaces the `pointIdx`th initial point by `p` and recomputes
+            the points that depend on it, which must have been computed with
+            parameter t (for example by fill()). Returns the new last point.
+
+            Point (col, idx) depends on the initial points idx...idx+col, so the
+            points that are recomputed form a cone that widens by one point per
+            column: far fewer than the whole scheme when `pointIdx` is near
+            either end of the polygon.
+        */
+        template< typename Scalar = float >
+        const Point &setPoint(int pointIdx, const Point &p, detail::NonDeduced<Scalar> t)
+        {
+            assert( isComplete() );
+
+            (*this)(0, pointIdx) = p;
+
+            for (int col = 1; col < mNumPoints; ++col)
+            {
+                int first = std::max(0, pointIdx - col);
+                int end = std::min(pointIdx + 1, mNumPoints - col);
+
+                for (int idx = first; idx < end; ++idx)
+                {
+                    const Point &p1 = (*this)(col - 1, idx);
+                    const Point &p2 = (*this)(col - 1, idx + 1);
+                    (*this)(col, idx) = p1 + t * (p2 - p1);
+                }
+            }
+
+            return last();
+        }
+
+        /**
+            @brief Finds the control polygon that maps [0,1] to the [t0,t1] part
+            of the curve, where the scheme must have been computed with
+            parameter t0 (by fill(), and possibly updated by setPoint()). The
+            `numPoints()` new points are written to `out`.
+
+            Unlike the vector-returning subdivide() below, this leaves the
+            scheme as it is. Calling it again with a different t1 therefore
+            does not recompute anything that only depends on t0, and after a
+            setPoint() only the cone of that point has been recomputed.
+
+            The new point K is obtained from the K + 1 points of column
+            `numPoints() - 1 - K` with K iterations of t1, in scratch memory
+            that is kept by the scheme.
+
+            Returns the output iterator one past the last point written.
+        */
+        template< typename Scalar = float, typename OutputIterator >
+        OutputIterator subdivide(detail::NonDeduced<Scalar> t1, OutputIterator out)
+        {
+            assert( isComplete() );
+
+            if (mRow.capacity() < std::size_t(mNumPoints))
+                CAGD_BEZIER_COUNT_ALLOCATION(sizeof(Point) * mNumPoints);
+            mRow.reserve(mNumPoints);
+
+            for (int newPointIdx = 0; newPointIdx < mNumPoints; ++newPointIdx)
+            {
+                int col = mNumPoints - 1 - newPointIdx;
+
+                mRow.assign(&(*this)(col, 0), &(*this)(col, 0) + newPointIdx + 1);
+
+                for (int iteration = 1; iteration <= newPointIdx; ++iteration)
+                    for (int idx = 0; idx <= newPointIdx - iteration; ++idx)
+                        mRow[idx] = mRow[idx] + t1 * (mRow[idx + 1] - mRow[idx]);
+
+                *out = mRow[0];
+                ++out;
+            }
+
+            return out;
+        }
+
+        /**
+            @brief The number of points in the scheme of a polygon of
+            `numPoints` points.
+        */
+        static int size(int numPoints)
+        {
+            return (numPoints * (numPoints + 1)) / 2;
+        }
+
     private:
+        void reserve(int numPoints)
+        {
+            if (mScheme.capacity() < std::size_t(size(numPoints)))
+                CAGD_BEZIER_COUNT_ALLOCATION(sizeof(Point) * size(numPoints));
+
+            mScheme.reserve(size(numPoints));
+        }
+
         int mNumPoints;
-        std::vector<Point> mScheme;
+        std::vector<Point, Allocator> mScheme;
+
+        // Scratch memory for subdivide().
+        std::vector<Point, Allocator> mRow;
+    };
+
+
+    /**
+        @brief Caller-owned scratch memory for the workspace overloads of
+        deCasteljau(), blossom() and subdivide() below.
+
+        A workspace grows to fit the largest polygon it has been used with and
+        keeps that memory, so once it has warmed up, evaluating through it does
+        not allocate. A workspace must not be shared between threads.
+    */
+    template< typename Point >
+    class DeCasteljauWorkspace
+    {
+    public:
+        typedef std::pmr::polymorphic_allocator<Point> SchemeAllocator;
+
+        /**
+            @brief Copies `points` into the workspace's scratch polygon and
+            returns a pointer to its first point.
+        */
+        Point *load(const std::vector<Point> &points)
+        {
+            return load(points.begin(), points.end());
+        }
+
+        /**
+            @brief Copies the points in [first, last) into the workspace's
+            scratch polygon and returns a pointer to its first point.
+        */
+        template< typename InputIterator >
+        Point *load(InputIterator first, InputIterator last)
+        {
+            std::size_t capacity = mPoints.capacity();
+            mPoints.assign(first, last);
+            if (mPoints.capacity() != capacity)
+                CAGD_BEZIER_COUNT_ALLOCATION(sizeof(Point) * mPoints.capacity());
+
+            return mPoints.data();
+        }
+
+        /**
+            @brief Returns an allocator for a DeCasteljauScheme of `numPoints`
+            points.
+
+            The allocator hands out memory from an arena owned by the workspace.
+            Every call rewinds the arena, so only one scheme obtained this way
+            may be alive at a time.
+        */
+        SchemeAllocator schemeAllocator(int numPoints)
+        {
+            // Room for the triangle and for the scratch row of
+            // DeCasteljauScheme::subdivide().
+            std::size_t bytes = sizeof(Point) * (DeCasteljauScheme<Point>::size(numPoints) + numPoints)
+                                + 2 * alignof(Point);
+
+            if (!mArena || mArenaBuffer.size() < bytes)
+            {
+                CAGD_BEZIER_COUNT_ALLOCATION(bytes);
+
+                mArena.reset();
+                mArenaBuffer.resize(bytes);
+                mArena.emplace(mArenaBuffer.data(), mArenaBuffer.size());
+            }
+            else
+            {
+                mArena->release();
+            }
+
+            return SchemeAllocator(&*mArena);
+        }
+
+    private:
+        std::vector<Point> mPoints;
+
+        std::vector<std::byte> mArenaBuffer;
+        std::optional<std::pmr::monotonic_buffer_resource> mArena;
     };
 
+    namespace detail
+    {
+
+        /**
+            @brief The body of the in-place deCasteljau() below, which the
+            batched version also runs where lanes do not pay off.
+        */
+        template< typename Scalar, typename Point >
+        inline Point deCasteljauInPlace(Point *points, int numPoints, Scalar t)
+        {
+            for (int iteration = 1; iteration < numPoints; ++iteration)
+                for (int pointIdx = 0; pointIdx < numPoints - iteration; ++pointIdx)
+                    points[pointIdx] = points[pointIdx] + t * (points[pointIdx + 1] - points[pointIdx]);
+
+            return points[0];
+        }
+
+    }
+
+
+    /**
+        @brief Performs the de Casteljau algorithm below in place on the
+        `numPoints` points starting at `points`, which are overwritten.
+    */
+    template< typename Scalar = float, typename Point >
+    inline Point deCasteljau(Point *points, int numPoints, detail::NonDeduced<Scalar> t)
+    {
+        CAGD_BEZIER_INSTRUMENT(DeCasteljau, numPoints - 1);
+
+        return detail::deCasteljauInPlace<Scalar>(points, numPoints, t);
+    }
+
+
     /**
         @brief Performs the de Casteljau algorithm with parameter t. This is used
         to find a point on the Bezier curve given its control polygon.
 
         The following expression must be valid with the Point type:
-            <Point> + <float> * (<Point> - <Point>)
+            <Point> + <Scalar> * (<Point> - <Point>)
 
         This is reasonable to assume since points are assumed to come from an
         affine space.
 
         The algorithm is performed inline on a copy of the vector that is passed in.
     */
-    template< typename Point >
-    inline Point deCasteljau(std::vector<Point> points, float t)
+    template< typename Scalar = float, typename Point >
+    inline Point deCasteljau(std::vector<Point> points, detail::NonDeduced<Scalar> t)
     {
-        int numPoints = points.size();
+        return deCasteljau<Scalar>(points.data(), points.size(), t);
+    }
 
-        for (int iteration = 1; iteration < numPoints; ++iteration)
-            for (int pointIdx = 0; pointIdx < numPoints - iteration; ++pointIdx)
-                points[pointIdx] = points[pointIdx] + t * (points[pointIdx + 1] - points[pointIdx]);
 
-        return points[0];
+    /**
+        @brief Performs the de Casteljau algorithm above using the scratch
+        memory of `workspace` instead of a fresh copy of `points`.
+    */
+    template< typename Scalar = float, typename Point >
+    inline Point deCasteljau(const std::vector<Point> &points, detail::NonDeduced<Scalar> t,
+                             DeCasteljauWorkspace<Point> &workspace)
+    {
+        return deCasteljau<Scalar>(workspace.load(points), points.size(), t);
+    }
+
+
+    namespace detail
+    {
+
+        /**
+            @brief The body of the batched deCasteljau() below, reading the
+            `numPoints` control points as `points[0]...points[numPoints - 1]`
+            from anything that can be indexed that way.
+        */
+        template< typename Point, typename Points, typename ParamIterator, typename OutputIterator >
+        inline OutputIterator deCasteljauLanes(const Points &points, int numPoints,
+                                               ParamIterator firstParam, ParamIterator lastParam,
+                                               OutputIterator out)
+        {
+            typedef typename std::iterator_traits<ParamIterator>::value_type Scalar;
+
+            CAGD_BEZIER_INSTRUMENT(DeCasteljauBatch, numPoints - 1);
+
+            if constexpr (!useLanes<Point>)
+            {
+                std::vector<Point> scratch(numPoints, points[0]);
+                CAGD_BEZIER_COUNT_ALLOCATION(sizeof(Point) * scratch.size());
+
+                for (; firstParam != lastParam; ++firstParam)
+                {
+                    for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+                        scratch[pointIdx] = points[pointIdx];
+
+                    *out++ = deCasteljauInPlace<Scalar>(scratch.data(), numPoints, *firstParam);
+                }
+
+                return out;
+            }
+
+            int lanes = laneCount();
+
+            // One interleaved copy of the control polygon per lane.
+            std::vector<Point> scratch(numPoints * lanes, points[0]);
+            CAGD_BEZIER_COUNT_ALLOCATION(sizeof(Point) * scratch.size());
+
+            Scalar params[MaxLanes];
+
+            while (firstParam != lastParam)
+            {
+                int count = 0;
+                for (; count < lanes && firstParam != lastParam; ++count, ++firstParam)
+                    params[count] = *firstParam;
+
+                // Lanes past the end of the input just repeat the last parameter.
+                std::fill(params + count, params + lanes, params[count - 1]);
+
+                for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+                    std::fill_n(scratch.begin() + pointIdx * lanes, lanes, points[pointIdx]);
+
+                runLanes(numPoints, params, 0, scratch.data());
+
+                out = std::copy(scratch.begin(), scratch.begin() + count, out);
+            }
+
+            return out;
+        }
+
     }
 
 
     /**
-        @brief Performs the de Casteljau algorithm with a different float in every
-        iteration. This allows one to compute the "blossom" of a polygon.
+        @brief Performs the de Casteljau algorithm above once for every parameter
+        in [firstParam, lastParam), writing the resulting points to `out` in order.
+
+        This is meant for evaluating many points on the same curve (for example,
+        when tessellating it). A single scratch buffer is allocated for the whole
+        batch, so nothing is allocated per parameter. For Points whose size is
+        a power of two, several parameters are evaluated side by side in lanes
+        that the compiler vectorizes (see lanes.h); the results are the same as
+        calling deCasteljau() once per parameter, up to rounding.
+
+        The parameters are of the iterator's value type, `Scalar`, and the
+        following expression must be valid with the Point type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+
+        Returns the output iterator one past the last point written.
+    */
+    template< typename Point, typename ParamIterator, typename OutputIterator >
+    inline OutputIterator deCasteljau(const std::vector<Point> &points,
+                                      ParamIterator firstParam, ParamIterator lastParam,
+                                      OutputIterator out)
+    {
+        return detail::deCasteljauLanes<Point>(points, points.size(), firstParam, lastParam, out);
+    }
+
+
+    namespace detail
+    {
+
+        /**
+            @brief The body of the in-place blossom() below, taking the
+            parameters of the iterations in order from `params`.
+        */
+        template< typename Point, typename ParamIterator >
+        inline Point blossomInPlace(Point *points, int numPoints, ParamIterator params)
+        {
+            for (int iteration = 1; iteration < numPoints; ++iteration, ++params)
+                for (int pointIdx = 0; pointIdx < numPoints - iteration; ++pointIdx)
+                    points[pointIdx] = points[pointIdx] + *params * (points[pointIdx + 1] - points[pointIdx]);
+
+            return points[0];
+        }
+
+    }
+
+
+    /**
+        @brief Performs the blossom algorithm below in place on the `numPoints`
+        points starting at `points`, which are overwritten. `params` must hold
+        `numPoints - 1` parameters.
+    */
+    template< typename Scalar = float, typename Point >
+    inline Point blossom(Point *points, int numPoints, const detail::NonDeduced<Scalar> *params)
+    {
+        CAGD_BEZIER_INSTRUMENT(Blossom, numPoints - 1);
+
+        return detail::blossomInPlace(points, numPoints, params);
+    }
+
+
+    /**
+        @brief Performs the de Casteljau algorithm with a different parameter in
+        every iteration. This allows one to compute the "blossom" of a polygon.
 
         params.size() must be equal to points.size() - 1.
 
         The following expression must be valid with the Point type:
-            <Point> + <float> * (<Point> - <Point>)
+            <Point> + <Scalar> * (<Point> - <Point>)
 
-        The algorithm is performed inline on a copy of the vector that is passed in.
+        The algorithm is performed inline on a copy of the vector that is passed
+        in. For many queries on the same polygon, see BlossomEvaluator in
+        blossomEvaluator.h.
     */
-    template< typename Point >
-    inline Point blossom(std::vector<Point> points, std::vector<float> params)
+    template< typename Scalar = float, typename Point >
+    inline Point blossom(std::vector<Point> points, const std::vector<detail::NonDeduced<Scalar>> &params)
     {
         assert( params.size() == points.size() - 1 );
 
-        int numPoints = points.size();
+        return blossom<Scalar>(points.data(), points.size(), params.data());
+    }
+
+
+    /**
+        @brief Performs the blossom algorithm above using the scratch memory of
+        `workspace` instead of a fresh copy of `points`.
+    */
+    template< typename Scalar = float, typename Point >
+    inline Point blossom(const std::vector<Point> &points,
+                         const std::vector<detail::NonDeduced<Scalar>> &params,
+                         DeCasteljauWorkspace<Point> &workspace)
+    {
+        assert( params.size() == points.size() - 1 );
+
+        return blossom<Scalar>(workspace.load(points), points.size(), params.data());
+    }
+
+
+    namespace detail
+    {
+
+        /**
+            @brief The body of the batched blossom() below, reading the control
+            points like deCasteljauLanes().
+        */
+        template< typename Point, typename Points, typename ParamsIterator, typename OutputIterator >
+        inline OutputIterator blossomLanes(const Points &points, int numPoints,
+                                           ParamsIterator firstParams, ParamsIterator lastParams,
+                                           OutputIterator out)
+        {
+            typedef typename std::iterator_traits<ParamsIterator>::value_type::value_type Scalar;
+
+            CAGD_BEZIER_INSTRUMENT(BlossomBatch, numPoints - 1);
+
+            if constexpr (!useLanes<Point>)
+            {
+                std::vector<Point> scratch(numPoints, points[0]);
+                CAGD_BEZIER_COUNT_ALLOCATION(sizeof(Point) * scratch.size());
+
+                for (; firstParams != lastParams; ++firstParams)
+                {
+                    assert( int(firstParams->size()) == numPoints - 1 );
+
+                    for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+                        scratch[pointIdx] = points[pointIdx];
+
+                    *out++ = blossomInPlace(scratch.data(), numPoints, firstParams->begin());
+                }
 
-        for (int iteration = 1; iteration < numPoints; ++iteration)
+                return out;
+            }
+
+            int lanes = laneCount();
+
+            std::vector<Point> scratch(numPoints * lanes, points[0]);
+
+            // params[(iteration - 1) * lanes + lane] is the parameter of `lane`
+            // in `iteration`.
+            std::vector<Scalar> params((numPoints - 1) * lanes);
+            CAGD_BEZIER_COUNT_ALLOCATION(sizeof(Point) * scratch.size() + sizeof(Scalar) * params.size());
+
+            while (firstParams != lastParams)
+            {
+                int count = 0;
+                for (; count < lanes && firstParams != lastParams; ++count, ++firstParams)
+                {
+                    assert( int(firstParams->size()) == numPoints - 1 );
+
+                    int iteration = 0;
+                    for (Scalar t : *firstParams)
+                        params[iteration++ * lanes + count] = t;
+                }
+
+                for (int lane = count; lane < lanes; ++lane)
+                    for (int iteration = 0; iteration < numPoints - 1; ++iteration)
+                        params[iteration * lanes + lane] = params[iteration * lanes + count - 1];
+
+                for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+                    std::fill_n(scratch.begin() + pointIdx * lanes, lanes, points[pointIdx]);
+
+                runLanes(numPoints, params.data(), lanes, scratch.data());
+
+                out = std::copy(scratch.begin(), scratch.begin() + count, out);
+            }
+
+            return out;
+        }
+
+    }
+
+
+    /**
+        @brief Computes the blossom above for every parameter sequence in
+        [firstParams, lastParams), writing the resulting points to `out` in order.
+
+        Each element of the input range must be a container of parameters
+        (such as std::vector<float>) of size points.size() - 1. Like the
+        batched deCasteljau() above, it uses a single scratch buffer, and
+        evaluates several sequences side by side in lanes for Points whose
+        size is a power of two.
+
+        The parameters are of the containers' value type, `Scalar`, and the
+        following expression must be valid with the Point type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+
+        Returns the output iterator one past the last point written.
+    */
+    template< typename Point, typename ParamsIterator, typename OutputIterator >
+    inline OutputIterator blossom(const std::vector<Point> &points,
+                                  ParamsIterator firstParams, ParamsIterator lastParams,
+                                  OutputIterator out)
+    {
+        return detail::blossomLanes<Point>(points, points.size(), firstParams, lastParams, out);
+    }
+
+
+    /**
+        @brief Performs the subdivide algorithm below in place on the `numPoints`
+        points starting at `points`, which are overwritten.
+    */
+    template< typename Scalar = float, typename Point >
+    inline Point subdivide(Point *points, int numPoints, int idx,
+                           detail::NonDeduced<Scalar> t0, detail::NonDeduced<Scalar> t1)
+    {
+        CAGD_BEZIER_INSTRUMENT(Subdivide, numPoints - 1);
+
+        int endT0 = numPoints - idx;
+
+
+        for (int iteration = 1; iteration < endT0; ++iteration)
             for (int pointIdx = 0; pointIdx < numPoints - iteration; ++pointIdx)
-                points[pointIdx] = points[pointIdx] + params[iteration - 1] * (points[pointIdx + 1] - points[pointIdx]);
+                points[pointIdx] = points[pointIdx] + t0 * (points[pointIdx + 1] - points[pointIdx]);
+
+        for (int iteration = endT0; iteration < numPoints; ++iteration)
+            for (int pointIdx = 0; pointIdx < numPoints - iteration; ++pointIdx)
+                points[pointIdx] = points[pointIdx] + t1 * (points[pointIdx + 1] - points[pointIdx]);
+
 
         return points[0];
     }
 
 
+    namespace detail
+    {
+
+        /**
+            @brief The body of the in-place split() below, on points and a
+            left half that can be indexed as `points[0]...points[numPoints - 1]`
+            and `left[0]...left[numPoints - 1]`.
+        */
+        template< typename Scalar, typename Points, typename Left >
+        inline void splitInPlace(Points &points, int numPoints, Scalar t, Left &left)
+        {
+            CAGD_BEZIER_INSTRUMENT(Split, numPoints - 1);
+
+            left[0] = points[0];
+
+            for (int iteration = 1; iteration < numPoints; ++iteration)
+            {
+                for (int pointIdx = 0; pointIdx < numPoints - iteration; ++pointIdx)
+                    points[pointIdx] = points[pointIdx] + t * (points[pointIdx + 1] - points[pointIdx]);
+
+                // The first point of every column is on the top diagonal. The last
+                // point of every column stays in place (it is never overwritten
+                // again) and forms the bottom diagonal.
+                left[iteration] = points[0];
+            }
+        }
+
+    }
+
+
+    /**
+        @brief Splits the curve of the `numPoints` points starting at `points` at
+        parameter t, using a single pass of the de Casteljau algorithm.
+
+        The scheme is computed in place. Afterwards, `points` holds the control
+        polygon of the [t,1] part of the curve (the bottom diagonal of the
+        scheme) and `left`, which must have room for `numPoints` points, holds
+        the control polygon of the [0,t] part (the top diagonal). These are the
+        same polygons as `subdivide(points, t, 1)` and `subdivide(points, 0, t)`.
+
+        The following expression must be valid with the Point type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+    */
+    template< typename Scalar = float, typename Point >
+    inline void split(Point *points, int numPoints, detail::NonDeduced<Scalar> t, Point *left)
+    {
+        detail::splitInPlace<Scalar>(points, numPoints, t, left);
+    }
+
+
+    /**
+        @brief Splits the curve of `points` at parameter t with the in-place
+        split() above, returning the control polygons of the [0,t] and [t,1]
+        parts of the curve (in that order).
+
+        This computes in one pass what `subdivide(points, 0, t)` and
+        `subdivide(points, t, 1)` compute in two, and allocates nothing but the
+        two returned polygons.
+    */
+    template< typename Scalar = float, typename Point >
+    inline std::pair<std::vector<Point>, std::vector<Point>> split(const std::vector<Point> &points,
+                                                                   detail::NonDeduced<Scalar> t)
+    {
+        std::pair<std::vector<Point>, std::vector<Point>> halves(points, points);
+
+        split<Scalar>(halves.second.data(), points.size(), t, halves.first.data());
+
+        return halves;
+    }
+
+
     /**
         @brief Performs the blossom algorithm above with the last `idx` parameters
         equal to `t1` and the rest equal to `t0`. It must be the case that
@@ -142,30 +800,91 @@ namespace Geometry::Bezier
         the original polygon's curve.
 
         The following expression must be valid with the Point type:
-            <Point> + <float> * (<Point> - <Point>)
+            <Point> + <Scalar> * (<Point> - <Point>)
 
         The algorithm is performed inline on a copy of the vector that is passed in.
     */
-    template< typename Point >
-    inline Point subdivide(std::vector<Point> points, int idx, float t0, float t1)
+    template< typename Scalar = float, typename Point >
+    inline Point subdivide(std::vector<Point> points, int idx,
+                           detail::NonDeduced<Scalar> t0, detail::NonDeduced<Scalar> t1)
     {
-        int numPoints = points.size();
+        return subdivide<Scalar>(points.data(), points.size(), idx, t0, t1);
+    }
+
 
-        int endT0 = points.size() - idx;
+    /**
+        @brief Performs the subdivide algorithm above using the scratch memory of
+        `workspace` instead of a fresh copy of `points`.
+    */
+    template< typename Scalar = float, typename Point >
+    inline Point subdivide(const std::vector<Point> &points, int idx,
+                           detail::NonDeduced<Scalar> t0, detail::NonDeduced<Scalar> t1,
+                           DeCasteljauWorkspace<Point> &workspace)
+    {
+        return subdivide<Scalar>(workspace.load(points), points.size(), idx, t0, t1);
+    }
 
 
-        for (int iteration = 1; iteration < endT0; ++iteration)
-            for (int pointIdx = 0; pointIdx < numPoints - iteration; ++pointIdx)
-                points[pointIdx] = points[pointIdx] + t0 * (points[pointIdx + 1] - points[pointIdx]);
+    namespace detail
+    {
 
-        for (int iteration = endT0; iteration < numPoints; ++iteration)
-            for (int pointIdx = 0; pointIdx < numPoints - iteration; ++pointIdx)
-                points[pointIdx] = points[pointIdx] + t1 * (points[pointIdx + 1] - points[pointIdx]);
+        /**
+            @brief The body of the vector-returning subdivide() below. `scheme`
+            must only contain the initial points; the `numPoints` new points
+            are written to `out`.
+        */
+        template< typename Scalar, typename Point, typename Allocator, typename OutputIterator >
+        inline OutputIterator subdivideScheme(DeCasteljauScheme<Point, Allocator> &scheme, int numPoints,
+                                              Scalar t0, Scalar t1, OutputIterator out)
+        {
+            CAGD_BEZIER_INSTRUMENT(Subdivide, numPoints - 1);
+
+            // Perform the iterations with t = t0, equivalent to the subdivide
+            // algorithm with idx = 0.
+            for (int iterationIdx = 1; iterationIdx < numPoints; ++iterationIdx)
+            {
+                for (int pointIdx = 0; pointIdx < numPoints - iterationIdx; ++pointIdx)
+                {
+                    const Point &p1 = scheme(iterationIdx - 1, pointIdx);
+                    const Point &p2 = scheme(iterationIdx - 1, pointIdx + 1);
 
+                    // The order of traversal is important here. Traverse the elements
+                    // in a column from bottom to top, then traverse columns left-to-right.
+                    scheme.push_back(p1 + t0 * (p2 - p1));
+                }
+            }
+
+            // This is the first point. It is equal to the result of
+            //   `subdivide(points, 0, t0, t1)`
+            *out = scheme.last();
+            ++out;
+
+            // Now figure out the other points. Since point K only requires the last
+            // K scalars to be t1, we can reuse some of the previous results.
+            for (int newPointIdx = 1; newPointIdx < numPoints; ++newPointIdx)
+            {
+                for (int iterationIdx = numPoints - newPointIdx; iterationIdx < numPoints; ++iterationIdx)
+                {
+                    for (int pointIdx = 0; pointIdx < numPoints - iterationIdx; ++pointIdx)
+                    {
+                        const Point &p1 = scheme(iterationIdx - 1, pointIdx);
+                        const Point &p2 = scheme(iterationIdx - 1, pointIdx + 1);
+                        scheme(iterationIdx, pointIdx) = p1 + t1 * (p2 - p1);
+                    }
+                }
+
+                // This is the same as the result of
+                //   `subdivide(points, newPointIdx, t0, t1)`
+                *out = scheme.last();
+                ++out;
+            }
+
+            return out;
+        }
 
-        return points[0];
     }
 
+
     /**
         @brief Performs the subdivide algorithm above for idx = 0...points.size()-1.
         Actually calling the above subdivide() N times on a set of N points would
@@ -178,10 +897,11 @@ namespace Geometry::Bezier
         polygon's curve.
 
         The following expression must be valid with the Point type:
-            <Point> + <float> * (<Point> - <Point>)
+            <Point> + <Scalar> * (<Point> - <Point>)
     */
-    template< typename Point >
-    inline std::vector<Point> subdivide(const std::vector<Point> &points, float t0, float t1)
+    template< typename Scalar = float, typename Point >
+    inline std::vector<Point> subdivide(const std::vector<Point> &points,
+                                        detail::NonDeduced<Scalar> t0, detail::NonDeduced<Scalar> t1)
     {
         int numPoints = points.size();
 
@@ -191,45 +911,32 @@ namespace Geometry::Bezier
         // This will store all columns of the de Casteljau scheme.
         DeCasteljauScheme<Point> scheme(points);
 
-        // Perform the iterations with t = t0, equivalent to the subdivide
-        // algorithm with idx = 0.
-        for (int iterationIdx = 1; iterationIdx < numPoints; ++iterationIdx)
-        {
-            for (int pointIdx = 0; pointIdx < numPoints - iterationIdx; ++pointIdx)
-            {
-                const Point &p1 = scheme(iterationIdx - 1, pointIdx);
-                const Point &p2 = scheme(iterationIdx - 1, pointIdx + 1);
+        detail::subdivideScheme<Scalar>(scheme, numPoints, t0, t1, std::back_inserter(newPoints));
 
-                // The order of traversal is important here. Traverse the elements
-                // in a column from bottom to top, then traverse columns left-to-right.
-                scheme.push_back(p1 + t0 * (p2 - p1));
-            }
-        }
+        return newPoints;
+    }
 
-        // This is the first point. It is equal to the result of
-        //   `subdivide(points, 0, t0, t1)`
-        newPoints.push_back(scheme.last());
 
-        // Now figure out the other points. Since point K only requires the last
-        // K scalars to be t1, we can reuse some of the previous results.
-        for (int newPointIdx = 1; newPointIdx < numPoints; ++newPointIdx)
-        {
-            for (int iterationIdx = numPoints - newPointIdx; iterationIdx < numPoints; ++iterationIdx)
-            {
-                for (int pointIdx = 0; pointIdx < numPoints - iterationIdx; ++pointIdx)
-                {
-                    const Point &p1 = scheme(iterationIdx - 1, pointIdx);
-                    const Point &p2 = scheme(iterationIdx - 1, pointIdx + 1);
-                    scheme(iterationIdx, pointIdx) = p1 + t1 * (p2 - p1);
-                }
-            }
+    /**
+        @brief Performs the vector-returning subdivide() above, with the de
+        Casteljau scheme allocated from `workspace`'s arena and the new points
+        written to `newPoints` (whose previous contents are discarded, but whose
+        capacity is reused).
+    */
+    template< typename Scalar = float, typename Point >
+    inline void subdivide(const std::vector<Point> &points,
+                          detail::NonDeduced<Scalar> t0, detail::NonDeduced<Scalar> t1,
+                          DeCasteljauWorkspace<Point> &workspace, std::vector<Point> &newPoints)
+    {
+        int numPoints = points.size();
 
-            // This is the same as the result of
-            //   `subdivide(points, newPointIdx, t0, t1)`
-            newPoints.push_back(scheme.last());
-        }
+        newPoints.clear();
+        newPoints.reserve(numPoints);
 
-        return newPoints;
+        DeCasteljauScheme<Point, typename DeCasteljauWorkspace<Point>::SchemeAllocator>
+            scheme(points, workspace.schemeAllocator(numPoints));
+
+        detail::subdivideScheme<Scalar>(scheme, numPoints, t0, t1, std::back_inserter(newPoints));
     }
 
 }
@@ -0,0 +1,389 @@
+#ifndef DEGREE_ELEVATION_H
+#define DEGREE_ELEVATION_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <optional>
+#include <cassert>
+
+#include "controlPolygonSoA.h"
+#include "pointTraits.h"
+
+namespace Geometry::Bezier
+{
+
+    /*
+        Degree elevation writes a curve of degree n as a curve of degree n + r
+        without changing it, and degree reduction approximates a curve by one
+        of lower degree. Together they bring a set of curves of mixed degrees
+        to a single degree, so that they can be processed by the fixed-degree
+        algorithms of fixedDegree.h or as one batch of equally sized SoA
+        polygons.
+    */
+
+    /**
+        @brief Writes the `numPoints + r` control points of the curve of
+        `points` (which has `numPoints` points), elevated by `r` degrees, to
+        `out`. `points` and `out` may be the same buffer, as long as it has
+        room for the elevated polygon.
+
+        Each step elevates by one degree, in place from the back:
+            b'_i = b_i + i / (n + 1) * (b_(i-1) - b_i)
+        so the following expression must be valid with the Point type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+    */
+    template< typename Scalar = float, typename Point >
+    inline void elevate(const Point *points, int numPoints, int r, Point *out)
+    {
+        assert( numPoints > 0 && r >= 0 );
+
+        if (out != points)
+            std::copy(points, points + numPoints, out);
+
+        for (int degree = numPoints - 1; degree < numPoints - 1 + r; ++degree)
+        {
+            out[degree + 1] = out[degree];
+            for (int i = degree; i > 0; --i)
+                out[i] = out[i] + Scalar(i) / Scalar(degree + 1) * (out[i - 1] - out[i]);
+        }
+    }
+
+
+    /**
+        @brief Returns the control polygon of the curve of `points` elevated by
+        `r` degrees.
+    */
+    template< typename Scalar = float, typename Point >
+    inline std::vector<Point> elevate(const std::vector<Point> &points, int r)
+    {
+        std::vector<Point> result(points.size() + r, points.front());
+        elevate<Scalar>(points.data(), points.size(), r, result.data());
+        return result;
+    }
+
+
+    /**
+        @brief How degree reduction treats the end points of a curve.
+    */
+    enum class ReductionEnds
+    {
+        /**
+            All control points are fitted by least squares. This gives the
+            smallest error in the control points, but the ends of the curve
+            move, so curves that met before may no longer meet.
+        */
+        Free,
+
+        /**
+            The first and last control points are kept, and only the others
+            are fitted, so curves that met before still meet.
+        */
+        Interpolated
+    };
+
+
+    /**
+        @brief The linear map from a control polygon of one degree to that of
+        another: exact degree elevation to a higher degree, and least-squares
+        degree reduction to a lower one.
+
+        Degree reduction finds the polygon c of the target degree m whose
+        elevation E c to the original degree n is closest to the original
+        polygon b in the least-squares sense, by solving the normal equations
+        (E^T E) c = E^T b, as in Farin. This minimizes the distances between
+        control points, which bound the distance between the curves; a curve
+        that is an elevated curve of degree m is recovered exactly.
+
+        The map only depends on the two degrees, so it is computed once, in
+        double precision, and then applied to any number of polygons. Each new
+        point is a combination of the old ones whose weights sum to 1, i.e.
+        an affine combination, which apply() evaluates as
+            b_0 + sum_j w_j (b_j - b_0)
+        so that only the following expression must be valid with the Point
+        type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+
+        For high degrees the normal equations become ill-conditioned; the
+        reduction is reliable up to degree 20 or so.
+    */
+    template< typename Scalar = float >
+    class DegreeChange
+    {
+    public:
+        DegreeChange(int fromDegree, int toDegree, ReductionEnds ends = ReductionEnds::Free)
+            : mFromDegree(fromDegree),
+              mToDegree(toDegree),
+              mWeights((toDegree + 1) * (fromDegree + 1))
+        {
+            assert( fromDegree >= 0 && toDegree >= 0 );
+            assert( ends == ReductionEnds::Free || toDegree >= 1 || fromDegree == 0 );
+
+            std::vector<double> weights = toDegree >= fromDegree ? elevationMatrix(fromDegree, toDegree)
+                                                                 : reductionMatrix(fromDegree, toDegree, ends);
+
+            std::copy(weights.begin(), weights.end(), mWeights.begin());
+        }
+
+        int fromDegree() const
+        {
+            return mFromDegree;
+        }
+
+        int toDegree() const
+        {
+            return mToDegree;
+        }
+
+        /**
+            @brief The weight of old point `j` in new point `k`.
+        */
+        Scalar weight(int k, int j) const
+        {
+            return mWeights[k * (mFromDegree + 1) + j];
+        }
+
+        /**
+            @brief Writes the `toDegree() + 1` new points of the polygon
+            `points`, which has `fromDegree() + 1` points, to `out`, which must
+            not overlap `points`.
+        */
+        template< typename Point >
+        void apply(const Point *points, Point *out) const
+        {
+            int numPoints = mFromDegree + 1;
+
+            for (int k = 0; k <= mToDegree; ++k)
+            {
+                Point p = points[0];
+                const Scalar *row = mWeights.data() + k * numPoints;
+                for (int j = 1; j < numPoints; ++j)
+                    p = p + row[j] * (points[j] - points[0]);
+                out[k] = p;
+            }
+        }
+
+        template< typename Point >
+        std::vector<Point> apply(const std::vector<Point> &points) const
+        {
+            assert( int(points.size()) == mFromDegree + 1 );
+
+            std::vector<Point> result(mToDegree + 1, points.front());
+            apply(points.data(), result.data());
+            return result;
+        }
+
+        /**
+            @brief Maps a structure-of-arrays polygon into `out`, which is
+            resized to `toDegree() + 1` points (keeping its memory). Each new
+            coordinate array is a small matrix-vector product on the old one.
+        */
+        template< int Dim >
+        void apply(ControlPolygonSoAView<Dim, Scalar> polygon, ControlPolygonSoA<Dim, Scalar> &out) const
+        {
+            assert( polygon.size() == mFromDegree + 1 );
+
+            int numPoints = mFromDegree + 1;
+            out.resize(mToDegree + 1);
+
+            for (int d = 0; d < Dim; ++d)
+            {
+                const Scalar *source = polygon.coordinates(d);
+                Scalar *target = out.coordinates(d);
+
+                for (int k = 0; k <= mToDegree; ++k)
+                {
+                    const Scalar *row = mWeights.data() + k * numPoints;
+
+                    Scalar sum = 0;
+                    for (int j = 0; j < numPoints; ++j)
+                        sum += row[j] * source[j];
+                    target[k] = sum;
+                }
+            }
+        }
+
+    private:
+        static double binomial(int n, int k)
+        {
+            double result = 1;
+            for (int i = 1; i <= k; ++i)
+                result = result * (n - k + i) / i;
+            return result;
+        }
+
+        /**
+            @brief E[i][k] = C(m, k) C(n - m, i - k) / C(n, i), the weight of
+            point k of degree m in point i of its elevation to degree n.
+        */
+        static std::vector<double> elevationMatrix(int m, int n)
+        {
+            std::vector<double> result((n + 1) * (m + 1), 0.0);
+            for (int i = 0; i <= n; ++i)
+                for (int k = std::max(0, i - (n - m)); k <= std::min(m, i); ++k)
+                    result[i * (m + 1) + k] = binomial(m, k) * binomial(n - m, i - k) / binomial(n, i);
+            return result;
+        }
+
+        /**
+            @brief The least-squares inverse of the elevation from `m` to `n`,
+            with the unknowns restricted to the interior points for
+            ReductionEnds::Interpolated.
+        */
+        static std::vector<double> reductionMatrix(int n, int m, ReductionEnds ends)
+        {
+            std::vector<double> elevation = elevationMatrix(m, n);
+            std::vector<double> result((m + 1) * (n + 1), 0.0);
+
+            // The unknowns are the points first...last of the reduced polygon;
+            // with interpolated ends, the others are fixed to the old ends.
+            bool interpolated = ends == ReductionEnds::Interpolated;
+            int first = interpolated ? 1 : 0, last = interpolated ? m - 1 : m;
+            int numUnknowns = last - first + 1;
+
+            if (interpolated)
+            {
+                result[0] = 1;
+                result[m * (n + 1) + n] = 1;
+            }
+
+            if (numUnknowns <= 0)
+                return result;
+
+            // The right-hand side b minus the elevations of the fixed points,
+            // as a matrix acting on b: rhs[i][j].
+            std::vector<double> rhs((n + 1) * (n + 1), 0.0);
+            for (int i = 0; i <= n; ++i)
+            {
+                rhs[i * (n + 1) + i] = 1;
+                if (interpolated)
+                {
+                    rhs[i * (n + 1)] -= elevation[i * (m + 1)];
+                    rhs[i * (n + 1) + n] -= elevation[i * (m + 1) + m];
+                }
+            }
+
+            // The normal equations A c = B b, with A = E^T E and B = E^T rhs
+            // over the unknown columns of E.
+            std::vector<double> a(numUnknowns * numUnknowns, 0.0);
+            std::vector<double> b(numUnknowns * (n + 1), 0.0);
+            for (int k = 0; k < numUnknowns; ++k)
+                for (int i = 0; i <= n; ++i)
+                {
+                    double e = elevation[i * (m + 1) + first + k];
+                    for (int l = 0; l < numUnknowns; ++l)
+                        a[k * numUnknowns + l] += e * elevation[i * (m + 1) + first + l];
+                    for (int j = 0; j <= n; ++j)
+                        b[k * (n + 1) + j] += e * rhs[i * (n + 1) + j];
+                }
+
+            // A is symmetric positive definite: solve by Cholesky, A = L L^T,
+            // with L stored over A's lower triangle.
+            for (int k = 0; k < numUnknowns; ++k)
+            {
+                for (int l = 0; l <= k; ++l)
+                {
+                    double sum = a[k * numUnknowns + l];
+                    for (int p = 0; p < l; ++p)
+                        sum -= a[k * numUnknowns + p] * a[l * numUnknowns + p];
+
+                    a[k * numUnknowns + l] = k == l ? std::sqrt(sum) : sum / a[l * numUnknowns + l];
+                }
+            }
+
+            for (int j = 0; j <= n; ++j)
+            {
+                for (int k = 0; k < numUnknowns; ++k)
+                {
+                    double sum = b[k * (n + 1) + j];
+                    for (int p = 0; p < k; ++p)
+                        sum -= a[k * numUnknowns + p] * b[p * (n + 1) + j];
+                    b[k * (n + 1) + j] = sum / a[k * numUnknowns + k];
+                }
+                for (int k = numUnknowns - 1; k >= 0; --k)
+                {
+                    double sum = b[k * (n + 1) + j];
+                    for (int p = k + 1; p < numUnknowns; ++p)
+                        sum -= a[p * numUnknowns + k] * b[p * (n + 1) + j];
+                    b[k * (n + 1) + j] = sum / a[k * numUnknowns + k];
+                }
+            }
+
+            for (int k = 0; k < numUnknowns; ++k)
+                std::copy(b.begin() + k * (n + 1), b.begin() + (k + 1) * (n + 1),
+                          result.begin() + (first + k) * (n + 1));
+
+            return result;
+        }
+
+        int mFromDegree;
+        int mToDegree;
+
+        // mWeights[k * (mFromDegree + 1) + j] is the weight of old point j in
+        // new point k.
+        std::vector<Scalar> mWeights;
+    };
+
+
+    /**
+        @brief Writes the `targetDegree + 1` points of the least-squares degree
+        reduction (see DegreeChange) of the curve of `points` to `out`, which
+        must not overlap `points`. For many curves of the same degree, reuse
+        one DegreeChange instead.
+    */
+    template< typename Scalar = float, typename Point >
+    inline void reduce(const Point *points, int numPoints, int targetDegree, Point *out,
+                       ReductionEnds ends = ReductionEnds::Free)
+    {
+        assert( targetDegree <= numPoints - 1 );
+
+        DegreeChange<Scalar>(numPoints - 1, targetDegree, ends).apply(points, out);
+    }
+
+
+    /**
+        @brief Returns the least-squares degree reduction of the curve of
+        `points` to `targetDegree`.
+    */
+    template< typename Scalar = float, typename Point >
+    inline std::vector<Point> reduce(const std::vector<Point> &points, int targetDegree,
+                                     ReductionEnds ends = ReductionEnds::Free)
+    {
+        std::vector<Point> result(targetDegree + 1, points.front());
+        reduce<Scalar>(points.data(), points.size(), targetDegree, result.data(), ends);
+        return result;
+    }
+
+
+    /**
+        @brief Brings every polygon of `polygons` to degree `degree`, by
+        elevation or by reduction, writing the results to `out` (which is
+        resized, and whose polygons keep their memory). One DegreeChange is
+        computed per distinct degree of the input.
+    */
+    template< int Dim, typename Scalar >
+    inline void changeDegree(const std::vector<ControlPolygonSoA<Dim, Scalar>> &polygons, int degree,
+                             std::vector<ControlPolygonSoA<Dim, Scalar>> &out,
+                             ReductionEnds ends = ReductionEnds::Free)
+    {
+        int numPolygons = polygons.size();
+        out.resize(numPolygons);
+
+        // changes[d] maps degree d to `degree`, once it is needed.
+        std::vector<std::optional<DegreeChange<Scalar>>> changes;
+
+        for (int polygonIdx = 0; polygonIdx < numPolygons; ++polygonIdx)
+        {
+            int fromDegree = polygons[polygonIdx].size() - 1;
+            if (int(changes.size()) <= fromDegree)
+                changes.resize(fromDegree + 1);
+            if (!changes[fromDegree])
+                changes[fromDegree].emplace(fromDegree, degree, ends);
+
+            changes[fromDegree]->apply(polygons[polygonIdx].view(), out[polygonIdx]);
+        }
+    }
+
+}
+
+#endif // DEGREE_ELEVATION_H
@@ -0,0 +1,218 @@
+#ifndef FIXED_DEGREE_H
+#define FIXED_DEGREE_H
+
+#include <array>
+#include <utility>
+#include <type_traits>
+
+#include "pointTraits.h"
+
+namespace Geometry::Bezier
+{
+
+    /*
+        Versions of the algorithms in deCasteljau.h for polygons whose degree is
+        known at compile time. They are called with an explicit degree, e.g.
+            deCasteljau<3>(cubicPoints, t)
+        and work on std::array<Point, Degree + 1>.
+
+        Every loop is expanded at compile time (see detail::unroll()), so there
+        are no loop bounds to check at runtime, and all functions are constexpr:
+        with a literal Point type (such as float) they can be used in constant
+        expressions.
+
+        As in deCasteljau.h, parameters are of type `Scalar`, which is float
+        unless it is given after the degree: deCasteljau<3, double>(points, t).
+    */
+
+    namespace detail
+    {
+
+        template< typename F, int... I >
+        constexpr void unrollImpl(F &f, std::integer_sequence<int, I...>)
+        {
+            (f(std::integral_constant<int, I>()), ...);
+        }
+
+        /**
+            @brief Calls `f(std::integral_constant<int, I>())` for I = 0...Count-1.
+        */
+        template< int Count, typename F >
+        constexpr void unroll(F &&f)
+        {
+            unrollImpl(f, std::make_integer_sequence<int, Count>());
+        }
+
+        template< typename Point, std::size_t... I >
+        constexpr std::array<Point, sizeof...(I)> filledArrayImpl(const Point &p, std::index_sequence<I...>)
+        {
+            return { { (static_cast<void>(I), p)... } };
+        }
+
+        /**
+            @brief An array of `N` copies of `p`. Unlike a default-initialized
+            array, this does not need Point to be default-constructible.
+        */
+        template< std::size_t N, typename Point >
+        constexpr std::array<Point, N> filledArray(const Point &p)
+        {
+            return filledArrayImpl(p, std::make_index_sequence<N>());
+        }
+
+    }
+
+
+    /**
+        @brief A DeCasteljauScheme for a polygon of degree `Degree`, stored in a
+        std::array. The position of every element is computed at compile time.
+    */
+    template< int Degree, typename Point >
+    class FixedDeCasteljauScheme
+    {
+    public:
+        static constexpr int NumPoints = Degree + 1;
+        static constexpr int Size = (NumPoints * (NumPoints + 1)) / 2;
+
+        constexpr FixedDeCasteljauScheme(const std::array<Point, NumPoints> &initialPoints)
+            : mScheme(detail::filledArray<Size>(initialPoints[0]))
+        {
+            for (int idx = 0; idx < NumPoints; ++idx)
+                mScheme[idx] = initialPoints[idx];
+        }
+
+        /**
+            @brief The position of the `idx`th element of the `col`th column.
+            Columns are laid out like in DeCasteljauScheme.
+        */
+        static constexpr int index(int col, int idx)
+        {
+            return ((2 * NumPoints - col + 1) * col) / 2 + idx;
+        }
+
+        constexpr const Point &operator() (int col, int idx) const
+        {
+            return mScheme[index(col, idx)];
+        }
+
+        constexpr Point &operator() (int col, int idx)
+        {
+            return mScheme[index(col, idx)];
+        }
+
+        /**
+            @brief Accesses the last point in the scheme (the one that is in
+            a column of its own).
+        */
+        constexpr const Point &last() const
+        {
+            return mScheme[Size - 1];
+        }
+
+    private:
+        std::array<Point, Size> mScheme;
+    };
+
+
+    /**
+        @brief Performs the de Casteljau algorithm with parameter t on a polygon
+        of degree `Degree`.
+
+        The following expression must be valid with the Point type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+    */
+    template< int Degree, typename Scalar = float, typename Point >
+    constexpr Point deCasteljau(std::array<Point, Degree + 1> points, detail::NonDeduced<Scalar> t)
+    {
+        detail::unroll<Degree>([&] (auto iterationIdx) {
+            constexpr int iteration = decltype(iterationIdx)::value + 1;
+
+            detail::unroll<Degree + 1 - iteration>([&] (auto pointIdx) {
+                constexpr int i = decltype(pointIdx)::value;
+                points[i] = points[i] + t * (points[i + 1] - points[i]);
+            });
+        });
+
+        return points[0];
+    }
+
+
+    /**
+        @brief Computes the blossom of a polygon of degree `Degree`, using
+        `params[iteration - 1]` in each iteration.
+
+        The following expression must be valid with the Point type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+    */
+    template< int Degree, typename Scalar = float, typename Point >
+    constexpr Point blossom(std::array<Point, Degree + 1> points,
+                            const std::array<detail::NonDeduced<Scalar>, Degree> &params)
+    {
+        detail::unroll<Degree>([&] (auto iterationIdx) {
+            constexpr int iteration = decltype(iterationIdx)::value + 1;
+
+            detail::unroll<Degree + 1 - iteration>([&] (auto pointIdx) {
+                constexpr int i = decltype(pointIdx)::value;
+                points[i] = points[i] + params[iteration - 1] * (points[i + 1] - points[i]);
+            });
+        });
+
+        return points[0];
+    }
+
+
+    /**
+        @brief Finds the control polygon of degree `Degree` that maps [0,1] to
+        the [t0,t1] part of `points`'s curve. This is the same algorithm as the
+        vector-returning subdivide() in deCasteljau.h.
+
+        The following expression must be valid with the Point type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+    */
+    template< int Degree, typename Scalar = float, typename Point >
+    constexpr std::array<Point, Degree + 1> subdivide(const std::array<Point, Degree + 1> &points,
+                                                      detail::NonDeduced<Scalar> t0,
+                                                      detail::NonDeduced<Scalar> t1)
+    {
+        constexpr int numPoints = Degree + 1;
+
+        FixedDeCasteljauScheme<Degree, Point> scheme(points);
+        std::array<Point, numPoints> newPoints(points);
+
+        // Fill in the scheme with t = t0.
+        detail::unroll<Degree>([&] (auto iterationIdx) {
+            constexpr int iteration = decltype(iterationIdx)::value + 1;
+
+            detail::unroll<numPoints - iteration>([&] (auto pointIdx) {
+                constexpr int i = decltype(pointIdx)::value;
+                const Point &p1 = scheme(iteration - 1, i);
+                const Point &p2 = scheme(iteration - 1, i + 1);
+                scheme(iteration, i) = p1 + t0 * (p2 - p1);
+            });
+        });
+
+        newPoints[0] = scheme.last();
+
+        // Point K only requires the last K iterations to use t1.
+        detail::unroll<Degree>([&] (auto newPointIdxMinusOne) {
+            constexpr int newPointIdx = decltype(newPointIdxMinusOne)::value + 1;
+
+            detail::unroll<newPointIdx>([&] (auto offset) {
+                constexpr int iteration = numPoints - newPointIdx + decltype(offset)::value;
+
+                detail::unroll<numPoints - iteration>([&] (auto pointIdx) {
+                    constexpr int i = decltype(pointIdx)::value;
+                    const Point &p1 = scheme(iteration - 1, i);
+                    const Point &p2 = scheme(iteration - 1, i + 1);
+                    scheme(iteration, i) = p1 + t1 * (p2 - p1);
+                });
+            });
+
+            newPoints[newPointIdx] = scheme.last();
+        });
+
+        return newPoints;
+    }
+
+}
+
+#endif // FIXED_DEGREE_H
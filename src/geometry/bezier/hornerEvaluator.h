@@ -0,0 +1,199 @@
+#ifndef HORNER_EVALUATOR_H
+#define HORNER_EVALUATOR_H
+
+#include <vector>
+#include <utility>
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief The coefficient forms HornerEvaluator can precompute.
+    */
+    enum class HornerBasis
+    {
+        /**
+            Scaled Bernstein form: the curve is written as
+                b_0 + sum_i C(n,i) t^i (1-t)^(n-i) (b_i - b_0)
+            and the sum is evaluated with Horner's rule in t/(1-t) for t <= 1/2,
+            and in (1-t)/t otherwise.
+        */
+        Bernstein,
+
+        /**
+            Power (monomial) form: the curve is written as
+                b_0 + sum_i C(n,i) (Delta^i b_0) t^i
+            and evaluated with Horner's rule in t.
+        */
+        Power
+    };
+
+
+    /**
+        @brief Evaluates points on a Bezier curve in Theta(N) time per point,
+        after a Theta(N^2) (power form) or Theta(N) (Bernstein form) setup per
+        control polygon, instead of the Theta(N^2) per point of deCasteljau().
+
+        The intermediate points of the de Casteljau scheme are not available,
+        and the result is less accurate. Measured against the de Casteljau
+        algorithm in double precision, over 200 random float polygons with
+        coordinates in [-1, 1] per degree and 1001 values of t in [0, 1], the
+        largest absolute errors were:
+
+            degree   deCasteljau()   Bernstein     Power
+                 1         1.2e-07     1.2e-07   1.2e-07
+                 2         2.2e-07     2.5e-07   3.1e-07
+                 3         3.0e-07     3.5e-07   7.7e-07
+                 5         3.8e-07     5.3e-07   8.6e-06
+                 8         5.4e-07     7.1e-07   1.4e-04
+                10         5.0e-07     8.6e-07   1.6e-03
+                15         6.7e-07     1.6e-06   3.2e-01
+                20         7.5e-07     1.5e-06   4.9e+01
+
+        So the Bernstein form (the default) stays within about twice the error
+        of deCasteljau() up to degree 20 and is safe to use for sampling. The
+        power form loses about half a decimal digit per degree; it is fine for
+        quadratics and cubics but should not be used beyond degree 4 or so.
+        Neither form is meant for extrapolation far outside of [0, 1].
+
+        Parameters, and the binomial weights of the coefficients, are of type
+        `Scalar`, which is float unless given explicitly, as in
+        HornerEvaluator<Point, double>. Besides the usual requirement of
+        affine combinations
+            <Point> + <Scalar> * (<Point> - <Point>)
+        this needs differences of points (Point - Point) to form a vector
+        space, i.e. the following must be valid as well:
+            <Vector> + <Vector>, <Scalar> * <Vector>
+    */
+    template< typename Point, typename Scalar = float >
+    class HornerEvaluator
+    {
+    public:
+        typedef decltype(std::declval<Point>() - std::declval<Point>()) Vector;
+
+        HornerEvaluator(const std::vector<Point> &points, HornerBasis basis = HornerBasis::Bernstein)
+            : mBasis(basis),
+              mOrigin(points[0])
+        {
+            int degree = points.size() - 1;
+
+            mCoefficients.reserve(degree);
+
+            if (basis == HornerBasis::Bernstein)
+            {
+                // mCoefficients[i - 1] = C(n, i) (b_i - b_0)
+                double binomial = 1;
+                for (int i = 1; i <= degree; ++i)
+                {
+                    binomial = binomial * (degree - i + 1) / i;
+                    mCoefficients.push_back(Scalar(binomial) * (points[i] - points[0]));
+                }
+            }
+            else
+            {
+                // Forward differences Delta^i b_0 are computed in place; after
+                // iteration i, differences[0] holds Delta^i b_0.
+                std::vector<Vector> differences;
+                differences.reserve(degree);
+                for (int i = 0; i < degree; ++i)
+                    differences.push_back(points[i + 1] - points[i]);
+
+                double binomial = 1;
+                for (int i = 1; i <= degree; ++i)
+                {
+                    binomial = binomial * (degree - i + 1) / i;
+                    mCoefficients.push_back(Scalar(binomial) * differences[0]);
+
+                    for (int k = 0; k < degree - i; ++k)
+                        differences[k] = differences[k + 1] + Scalar(-1) * differences[k];
+                }
+            }
+        }
+
+        /**
+            @brief The degree of the curve.
+        */
+        int degree() const
+        {
+            return mCoefficients.size();
+        }
+
+        /**
+            @brief Evaluates the curve at `t`.
+        */
+        Point operator() (Scalar t) const
+        {
+            int n = degree();
+
+            if (n == 0)
+                return mOrigin;
+
+            if (mBasis == HornerBasis::Power)
+            {
+                Vector acc = mCoefficients[n - 1];
+                for (int i = n - 2; i >= 0; --i)
+                    acc = t * acc + mCoefficients[i];
+
+                return mOrigin + t * acc;
+            }
+
+            Scalar s = 1 - t;
+
+            if (t <= Scalar(0.5))
+            {
+                // sum_i c_i t^i s^(n-i) = s^n sum_i c_i u^i with u = t / s.
+                Scalar u = t / s;
+
+                Vector acc = mCoefficients[n - 1];
+                for (int i = n - 2; i >= 0; --i)
+                    acc = u * acc + mCoefficients[i];
+
+                Scalar scale = u;
+                for (int i = 0; i < n; ++i)
+                    scale *= s;
+
+                return mOrigin + scale * acc;
+            }
+            else
+            {
+                // sum_i c_i t^i s^(n-i) = t^n sum_i c_i v^(n-i) with v = s / t.
+                Scalar v = s / t;
+
+                Vector acc = mCoefficients[0];
+                for (int i = 1; i < n; ++i)
+                    acc = v * acc + mCoefficients[i];
+
+                Scalar scale = 1;
+                for (int i = 0; i < n; ++i)
+                    scale *= t;
+
+                return mOrigin + scale * acc;
+            }
+        }
+
+        /**
+            @brief Evaluates the curve at every parameter in [firstParam, lastParam),
+            writing the points to `out` in order. Returns the output iterator one
+            past the last point written.
+        */
+        template< typename ParamIterator, typename OutputIterator >
+        OutputIterator operator() (ParamIterator firstParam, ParamIterator lastParam, OutputIterator out) const
+        {
+            for (; firstParam != lastParam; ++firstParam)
+            {
+                *out = (*this)(*firstParam);
+                ++out;
+            }
+
+            return out;
+        }
+
+    private:
+        HornerBasis mBasis;
+        Point mOrigin;
+        std::vector<Vector> mCoefficients;
+    };
+
+}
+
+#endif // HORNER_EVALUATOR_H
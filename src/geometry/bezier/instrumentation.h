@@ -0,0 +1,285 @@
+#ifndef BEZIER_INSTRUMENTATION_H
+#define BEZIER_INSTRUMENTATION_H
+
+/*
+    Opt-in instrumentation of the hot paths of deCasteljau.h and
+    controlPolygonSoA.h: how often deCasteljau(), blossom(), subdivide() and
+    split() are called, for which degrees, how long they take, and how often
+    the scratch memory of the algorithms is allocated.
+
+    Everything is off unless the program is built with
+        CAGD_BEZIER_INSTRUMENTATION          call counts, degree histograms
+                                             and allocation counts
+        CAGD_BEZIER_INSTRUMENTATION_TIMING   also the time spent in the calls
+                                             (implies the above)
+    defined for every translation unit, which the .pro files do with
+    `qmake CONFIG+=cagd_instrumentation` (or `cagd_instrumentation_timing`).
+    The instrumented functions are inline, so defining the macros in only
+    some translation units gives one function two definitions, which is
+    undefined behaviour and in practice drops counts depending on which
+    definition the linker keeps.
+
+    When instrumentation is off, the macros below expand to nothing, so
+    instrumented builds and normal builds run the same code apart from the
+    counters, and the stats functions return zeros. The counters are relaxed
+    atomics shared by all threads, which is cheap but not free under
+    contention, so they are meant for profiling builds rather than for
+    shipping.
+
+    Independently of the above, every instrumented function opens a trace
+    scope through CAGD_BEZIER_TRACE_SCOPE(name), where `name` is a string
+    literal. It expands to nothing unless it is defined before the headers are
+    included, again identically in every translation unit (for example in a
+    header the build force-includes), such as
+        #define CAGD_BEZIER_TRACE_SCOPE(name) ZoneScopedN(name)          // Tracy
+        #define CAGD_BEZIER_TRACE_SCOPE(name) TRACE_EVENT("cagd", name)  // Perfetto
+    Since the scopes are very short, this is best combined with the tracer's
+    own sampling or filtering.
+*/
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(CAGD_BEZIER_INSTRUMENTATION_TIMING) && !defined(CAGD_BEZIER_INSTRUMENTATION)
+#define CAGD_BEZIER_INSTRUMENTATION 1
+#endif
+
+#ifndef CAGD_BEZIER_TRACE_SCOPE
+#define CAGD_BEZIER_TRACE_SCOPE(name)
+#endif
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief The functions whose calls are counted. The batched versions are
+        counted once per batch, not once per parameter.
+    */
+    enum class InstrumentedFunction
+    {
+        DeCasteljau,
+        DeCasteljauBatch,
+        Blossom,
+        BlossomBatch,
+        Subdivide,
+        Split,
+        Count
+    };
+
+    constexpr int NumInstrumentedFunctions = int(InstrumentedFunction::Count);
+
+    /**
+        @brief The number of buckets of the degree histograms. The last one
+        counts all calls of that degree or higher.
+    */
+    constexpr int NumDegreeBuckets = 32;
+
+    inline const char *functionName(InstrumentedFunction function)
+    {
+        static const char *const names[NumInstrumentedFunctions] = {
+            "deCasteljau", "deCasteljau (batch)", "blossom", "blossom (batch)", "subdivide", "split"
+        };
+        return names[int(function)];
+    }
+
+    /**
+        @brief Whether this translation unit was compiled with
+        CAGD_BEZIER_INSTRUMENTATION.
+    */
+    constexpr bool instrumentationEnabled()
+    {
+#ifdef CAGD_BEZIER_INSTRUMENTATION
+        return true;
+#else
+        return false;
+#endif
+    }
+
+
+    /**
+        @brief The counters of one instrumented function.
+    */
+    struct FunctionStats
+    {
+        std::uint64_t calls = 0;
+
+        // Zero unless compiled with CAGD_BEZIER_INSTRUMENTATION_TIMING.
+        std::uint64_t nanoseconds = 0;
+
+        // degrees[d] is the number of calls on polygons of degree d.
+        std::array<std::uint64_t, NumDegreeBuckets> degrees {};
+    };
+
+
+    /**
+        @brief A snapshot of all counters, from instrumentationStats().
+    */
+    struct InstrumentationStats
+    {
+        std::array<FunctionStats, NumInstrumentedFunctions> functions;
+
+        // Allocations of scratch memory by the algorithms, DeCasteljauScheme,
+        // DeCasteljauWorkspace and ControlPolygonSoAWorkspace, and their
+        // total size.
+        std::uint64_t allocations = 0;
+        std::uint64_t allocatedBytes = 0;
+
+        const FunctionStats &operator[] (InstrumentedFunction function) const
+        {
+            return functions[int(function)];
+        }
+    };
+
+
+    namespace detail
+    {
+
+        struct InstrumentationCounters
+        {
+            struct Function
+            {
+                std::atomic<std::uint64_t> calls { 0 };
+                std::atomic<std::uint64_t> nanoseconds { 0 };
+                std::array<std::atomic<std::uint64_t>, NumDegreeBuckets> degrees {};
+            };
+
+            std::array<Function, NumInstrumentedFunctions> functions;
+            std::atomic<std::uint64_t> allocations { 0 };
+            std::atomic<std::uint64_t> allocatedBytes { 0 };
+        };
+
+        inline InstrumentationCounters &instrumentationCounters()
+        {
+            static InstrumentationCounters counters;
+            return counters;
+        }
+
+        inline void countCall(InstrumentedFunction function, int degree)
+        {
+            InstrumentationCounters::Function &counters = instrumentationCounters().functions[int(function)];
+
+            int bucket = degree < 0 ? 0 : degree < NumDegreeBuckets ? degree : NumDegreeBuckets - 1;
+            counters.calls.fetch_add(1, std::memory_order_relaxed);
+            counters.degrees[bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        inline void countAllocation(std::size_t bytes)
+        {
+            InstrumentationCounters &counters = instrumentationCounters();
+            counters.allocations.fetch_add(1, std::memory_order_relaxed);
+            counters.allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+
+        /**
+            @brief Counts a call when it is constructed and, with
+            CAGD_BEZIER_INSTRUMENTATION_TIMING, adds the time until it is
+            destroyed.
+        */
+        class InstrumentationScope
+        {
+        public:
+            InstrumentationScope(InstrumentedFunction function, int degree)
+#ifdef CAGD_BEZIER_INSTRUMENTATION_TIMING
+                : mFunction(function),
+                  mStart(std::chrono::steady_clock::now())
+#endif
+            {
+                countCall(function, degree);
+            }
+
+#ifdef CAGD_BEZIER_INSTRUMENTATION_TIMING
+            ~InstrumentationScope()
+            {
+                auto elapsed = std::chrono::steady_clock::now() - mStart;
+                instrumentationCounters().functions[int(mFunction)].nanoseconds.fetch_add(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                    std::memory_order_relaxed);
+            }
+#endif
+
+            InstrumentationScope(const InstrumentationScope &) = delete;
+            InstrumentationScope &operator= (const InstrumentationScope &) = delete;
+
+        private:
+#ifdef CAGD_BEZIER_INSTRUMENTATION_TIMING
+            InstrumentedFunction mFunction;
+            std::chrono::steady_clock::time_point mStart;
+#endif
+        };
+
+    }
+
+
+    /**
+        @brief Reads all counters. While other threads are running
+        instrumented code, the snapshot is not atomic as a whole.
+    */
+    inline InstrumentationStats instrumentationStats()
+    {
+        const detail::InstrumentationCounters &counters = detail::instrumentationCounters();
+
+        InstrumentationStats stats;
+        for (int function = 0; function < NumInstrumentedFunctions; ++function)
+        {
+            const detail::InstrumentationCounters::Function &source = counters.functions[function];
+            FunctionStats &target = stats.functions[function];
+
+            target.calls = source.calls.load(std::memory_order_relaxed);
+            target.nanoseconds = source.nanoseconds.load(std::memory_order_relaxed);
+            for (int bucket = 0; bucket < NumDegreeBuckets; ++bucket)
+                target.degrees[bucket] = source.degrees[bucket].load(std::memory_order_relaxed);
+        }
+        stats.allocations = counters.allocations.load(std::memory_order_relaxed);
+        stats.allocatedBytes = counters.allocatedBytes.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+
+
+    /**
+        @brief Sets all counters to zero, for example at the start of a frame.
+    */
+    inline void resetInstrumentationStats()
+    {
+        detail::InstrumentationCounters &counters = detail::instrumentationCounters();
+
+        for (detail::InstrumentationCounters::Function &function : counters.functions)
+        {
+            function.calls.store(0, std::memory_order_relaxed);
+            function.nanoseconds.store(0, std::memory_order_relaxed);
+            for (std::atomic<std::uint64_t> &bucket : function.degrees)
+                bucket.store(0, std::memory_order_relaxed);
+        }
+        counters.allocations.store(0, std::memory_order_relaxed);
+        counters.allocatedBytes.store(0, std::memory_order_relaxed);
+    }
+
+}
+
+
+/*
+    CAGD_BEZIER_INSTRUMENT(function, degree) opens the scope of a call of
+    `function` (an InstrumentedFunction enumerator) on a polygon of `degree`,
+    and CAGD_BEZIER_COUNT_ALLOCATION(bytes) counts an allocation. The
+    arguments are not evaluated when instrumentation is off.
+*/
+#ifdef CAGD_BEZIER_INSTRUMENTATION
+
+#define CAGD_BEZIER_INSTRUMENT(function, degree)                                                  \
+    CAGD_BEZIER_TRACE_SCOPE(#function);                                                            \
+    ::Geometry::Bezier::detail::InstrumentationScope cagdInstrumentationScope(                     \
+        ::Geometry::Bezier::InstrumentedFunction::function, (degree))
+
+#define CAGD_BEZIER_COUNT_ALLOCATION(bytes) ::Geometry::Bezier::detail::countAllocation(bytes)
+
+#else
+
+#define CAGD_BEZIER_INSTRUMENT(function, degree) CAGD_BEZIER_TRACE_SCOPE(#function)
+#define CAGD_BEZIER_COUNT_ALLOCATION(bytes) ((void)0)
+
+#endif
+
+#endif // BEZIER_INSTRUMENTATION_H
@@ -0,0 +1,410 @@
+#ifndef INTERSECTION_H
+#define INTERSECTION_H
+
+#include <array>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <cassert>
+
+#include "deCasteljau.h"
+#include "adaptiveTessellation.h"
+#include "boundingBox.h"
+#include "pointTraits.h"
+#include "../../concurrency/workStealingPool.h"
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief A point where two curves meet: the first curve at parameter `t`
+        and the second at parameter `u`.
+    */
+    template< typename Scalar >
+    struct CurveIntersection
+    {
+        Scalar t;
+        Scalar u;
+    };
+
+
+    /**
+        @brief An intersection of the `first`th and the `second`th curve of a
+        set, at parameter `t` on the former and `u` on the latter.
+    */
+    template< typename Scalar >
+    struct CurvePairIntersection
+    {
+        int first;
+        int second;
+        Scalar t;
+        Scalar u;
+    };
+
+
+    namespace detail
+    {
+
+        /**
+            @brief Finds the closest points p0 + s (p1 - p0) and q0 + v (q1 - q0)
+            of two segments, with s and v in [0,1], and returns their squared
+            distance.
+        */
+        template< typename Coordinate, std::size_t Dim >
+        Coordinate closestOnSegments(const std::array<Coordinate, Dim> &p0, const std::array<Coordinate, Dim> &p1,
+                                     const std::array<Coordinate, Dim> &q0, const std::array<Coordinate, Dim> &q1,
+                                     Coordinate &s, Coordinate &v)
+        {
+            std::array<Coordinate, Dim> dp, dq, r;
+            for (std::size_t d = 0; d < Dim; ++d)
+            {
+                dp[d] = p1[d] - p0[d];
+                dq[d] = q1[d] - q0[d];
+                r[d] = p0[d] - q0[d];
+            }
+
+            Coordinate a = 0, b = 0, c = 0, e = 0, f = 0;
+            for (std::size_t d = 0; d < Dim; ++d)
+            {
+                a += dp[d] * dp[d];
+                b += dp[d] * dq[d];
+                c += dp[d] * r[d];
+                e += dq[d] * dq[d];
+                f += dq[d] * r[d];
+            }
+
+            // Minimize |r + s dp - v dq|^2 over the unit square: first s for the
+            // infinite lines (s = 0 for parallel or degenerate ones), then v for
+            // that s, then s again for the clamped v.
+            Coordinate denominator = a * e - b * b;
+            s = denominator > 0 ? std::clamp((b * f - c * e) / denominator, Coordinate(0), Coordinate(1)) : 0;
+            v = e > 0 ? std::clamp((b * s + f) / e, Coordinate(0), Coordinate(1)) : 0;
+            s = a > 0 ? std::clamp((b * v - c) / a, Coordinate(0), Coordinate(1)) : 0;
+
+            Coordinate result = 0;
+            for (std::size_t d = 0; d < Dim; ++d)
+            {
+                Coordinate gap = r[d] + s * dp[d] - v * dq[d];
+                result += gap * gap;
+            }
+            return result;
+        }
+
+    }
+
+
+    /**
+        @brief Finds the intersections of pairs of curves by interval
+        subdivision, reusing its memory from one pair to the next.
+
+        Pairs of pieces of the two curves are kept on an explicit work stack,
+        starting with the whole curves. A pair whose bounding boxes are
+        disjoint cannot intersect (by the convex hull property) and is
+        dropped. Otherwise, the piece whose control polygon is farther from
+        straight (see flatness()) is split in half with split(), until both are
+        within `tolerance` of their chords. Then each curve is within
+        `tolerance` of its chord, and the pair is reported if the chords come
+        within twice the tolerance of each other, at the parameters of their
+        closest points.
+
+        Boxes keep overlapping along a tangency, so tangential intersections
+        are found too (unlike with sampling); they come out as a run of
+        neighbouring piece pairs. Reports whose parameter intervals touch on
+        both curves are merged into the one with the smallest gap, so every
+        intersection is reported once, as is every overlapping stretch of two
+        curves. Parameters are accurate to about `tolerance` divided by the
+        speed of the curve there.
+
+        Intersections of a curve with itself are not looked for. PointTraits
+        must be specialized for Point, and the following expression must be
+        valid with the Point type:
+            <Point> + <Scalar> * (<Point> - <Point>)
+    */
+    template< typename Point, typename Scalar = float >
+    class CurveIntersector
+    {
+        typedef PointTraits<Point> Traits;
+
+    public:
+        typedef typename Traits::Scalar Coordinate;
+        typedef CurveIntersection<Scalar> Intersection;
+
+        /**
+            @brief Pieces are split at most `maxDepth` times. Pairs that reach
+            that depth are tested against their chords whether or not they are
+            flat.
+        */
+        explicit CurveIntersector(Coordinate tolerance, int maxDepth = 24)
+            : mTolerance(tolerance),
+              mMaxDepth(maxDepth)
+        {
+        }
+
+        Coordinate tolerance() const
+        {
+            return mTolerance;
+        }
+
+        /**
+            @brief Writes the intersections of the curves of `first` and
+            `second` to `out`, in increasing order of `t`.
+
+            Returns the output iterator one past the last intersection written.
+        */
+        template< typename OutputIterator >
+        OutputIterator operator() (const std::vector<Point> &first, const std::vector<Point> &second,
+                                   OutputIterator out)
+        {
+            int sizeA = first.size();
+            int sizeB = second.size();
+
+            mHits.clear();
+            mTasks.clear();
+            mStack.clear();
+
+            mTasks.push_back(Task { 0, 1, 0, 1, 0 });
+            mStack.insert(mStack.end(), first.begin(), first.end());
+            mStack.insert(mStack.end(), second.begin(), second.end());
+
+            while (!mTasks.empty())
+            {
+                Task task = mTasks.back();
+                mTasks.pop_back();
+
+                auto top = mStack.end() - (sizeA + sizeB);
+                mA.assign(top, top + sizeA);
+                mB.assign(top + sizeA, mStack.end());
+                mStack.erase(top, mStack.end());
+
+                if (!boundingBox(mA).intersects(boundingBox(mB)))
+                    continue;
+
+                Coordinate flatnessA = sizeA > 2 ? flatness(mA.data(), sizeA) : 0;
+                Coordinate flatnessB = sizeB > 2 ? flatness(mB.data(), sizeB) : 0;
+
+                if ((flatnessA <= mTolerance && flatnessB <= mTolerance) || task.depth >= mMaxDepth)
+                {
+                    testChords(task);
+                    continue;
+                }
+
+                // Split the piece that is farther from straight, and queue
+                // the left halves last, so that they are processed first.
+                bool splitA = flatnessA >= flatnessB;
+                std::vector<Point> &piece = splitA ? mA : mB;
+                int numPoints = piece.size();
+
+                mLeft.assign(piece.begin(), piece.end());
+                split<Scalar>(piece.data(), numPoints, 0.5, mLeft.data());
+
+                Task right = task, left = task;
+                right.depth = left.depth = task.depth + 1;
+                if (splitA)
+                    left.a1 = right.a0 = (task.a0 + task.a1) / 2;
+                else
+                    left.b1 = right.b0 = (task.b0 + task.b1) / 2;
+
+                push(right, mA, mB);
+                if (splitA)
+                    push(left, mLeft, mB);
+                else
+                    push(left, mA, mLeft);
+            }
+
+            return mergeHits(out);
+        }
+
+    private:
+        // The pieces of a task span [a0, a1] of the first curve and [b0, b1] of
+        // the second. Their control points are on mStack, in the same order as
+        // the tasks.
+        struct Task
+        {
+            Scalar a0, a1, b0, b1;
+            int depth;
+        };
+
+        struct Hit
+        {
+            Scalar t, u;
+            Coordinate gapSquared;
+            Scalar a0, a1, b0, b1;
+        };
+
+        void push(const Task &task, const std::vector<Point> &a, const std::vector<Point> &b)
+        {
+            mTasks.push_back(task);
+            mStack.insert(mStack.end(), a.begin(), a.end());
+            mStack.insert(mStack.end(), b.begin(), b.end());
+        }
+
+        void testChords(const Task &task)
+        {
+            Coordinate s, v;
+            Coordinate gapSquared = detail::closestOnSegments(
+                detail::coordinatesOf(mA.front()), detail::coordinatesOf(mA.back()),
+                detail::coordinatesOf(mB.front()), detail::coordinatesOf(mB.back()), s, v);
+
+            if (gapSquared > 4 * mTolerance * mTolerance)
+                return;
+
+            mHits.push_back(Hit { task.a0 + Scalar(s) * (task.a1 - task.a0),
+                                  task.b0 + Scalar(v) * (task.b1 - task.b0),
+                                  gapSquared, task.a0, task.a1, task.b0, task.b1 });
+        }
+
+        template< typename OutputIterator >
+        OutputIterator mergeHits(OutputIterator out)
+        {
+            std::sort(mHits.begin(), mHits.end(), [] (const Hit &p, const Hit &q) { return p.a0 < q.a0; });
+
+            // Every cluster is the union of the parameter intervals of the hits
+            // merged into it, and keeps the hit with the smallest gap.
+            mClusters.clear();
+            for (const Hit &hit : mHits)
+            {
+                bool merged = false;
+                for (Hit &cluster : mClusters)
+                {
+                    if (hit.a0 <= cluster.a1 && hit.b0 <= cluster.b1 && cluster.b0 <= hit.b1)
+                    {
+                        if (hit.gapSquared < cluster.gapSquared)
+                        {
+                            cluster.t = hit.t;
+                            cluster.u = hit.u;
+                            cluster.gapSquared = hit.gapSquared;
+                        }
+                        cluster.a1 = std::max(cluster.a1, hit.a1);
+                        cluster.b0 = std::min(cluster.b0, hit.b0);
+                        cluster.b1 = std::max(cluster.b1, hit.b1);
+                        merged = true;
+                        break;
+                    }
+                }
+
+                if (!merged)
+                    mClusters.push_back(hit);
+            }
+
+            std::sort(mClusters.begin(), mClusters.end(), [] (const Hit &p, const Hit &q) { return p.t < q.t; });
+
+            for (const Hit &cluster : mClusters)
+            {
+                *out = Intersection { cluster.t, cluster.u };
+                ++out;
+            }
+
+            return out;
+        }
+
+        Coordinate mTolerance;
+        int mMaxDepth;
+
+        std::vector<Task> mTasks;
+        std::vector<Point> mStack;
+        std::vector<Point> mA, mB, mLeft;
+
+        std::vector<Hit> mHits;
+        std::vector<Hit> mClusters;
+    };
+
+
+    /**
+        @brief Writes the intersections of the curves of `first` and `second`
+        to `out` with a CurveIntersector, in increasing order of the parameter
+        on `first`.
+    */
+    template< typename Scalar = float, typename Point, typename OutputIterator >
+    inline OutputIterator intersect(const std::vector<Point> &first, const std::vector<Point> &second,
+                                    typename PointTraits<Point>::Scalar tolerance, OutputIterator out)
+    {
+        CurveIntersector<Point, Scalar> intersector(tolerance);
+        return intersector(first, second, out);
+    }
+
+
+    /**
+        @brief Finds the pairs of curves in `curves` whose bounding boxes
+        intersect, as (i, j) with i < j, by sweeping the boxes along the first
+        axis. Only these pairs can have intersections.
+    */
+    template< typename Point >
+    inline std::vector<std::pair<int, int>> overlappingPairs(const std::vector<std::vector<Point>> &curves)
+    {
+        int numCurves = curves.size();
+
+        std::vector<BoundingBoxOf<Point>> boxes;
+        boxes.reserve(numCurves);
+        for (const std::vector<Point> &curve : curves)
+            boxes.push_back(boundingBox(curve));
+
+        std::vector<int> order(numCurves);
+        for (int curveIdx = 0; curveIdx < numCurves; ++curveIdx)
+            order[curveIdx] = curveIdx;
+        std::sort(order.begin(), order.end(),
+                  [&] (int a, int b) { return boxes[a].lower[0] < boxes[b].lower[0]; });
+
+        std::vector<std::pair<int, int>> pairs;
+        for (int k = 0; k < numCurves; ++k)
+        {
+            const BoundingBoxOf<Point> &box = boxes[order[k]];
+
+            for (int l = k + 1; l < numCurves && boxes[order[l]].lower[0] <= box.upper[0]; ++l)
+                if (box.intersects(boxes[order[l]]))
+                    pairs.push_back(std::minmax(order[k], order[l]));
+        }
+
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+
+    /**
+        @brief Finds all intersections between pairs of different curves in
+        `curves` with CurveIntersector, ordered by the pair and then by `t`.
+
+        Only pairs whose bounding boxes intersect (see overlappingPairs()) are
+        examined. They are handed to the pool in chunks of `grainSize` pairs,
+        each with its own CurveIntersector, so memory is allocated per chunk.
+    */
+    template< typename Scalar = float, typename Point >
+    inline std::vector<CurvePairIntersection<Scalar>>
+    intersectBatch(Concurrency::WorkStealingPool &pool, const std::vector<std::vector<Point>> &curves,
+                   typename PointTraits<Point>::Scalar tolerance, int grainSize = 16)
+    {
+        std::vector<std::pair<int, int>> pairs = overlappingPairs(curves);
+
+        int numPairs = pairs.size();
+        grainSize = std::max(1, grainSize);
+        int numChunks = (numPairs + grainSize - 1) / grainSize;
+
+        std::vector<std::vector<CurvePairIntersection<Scalar>>> chunkResults(numChunks);
+
+        pool.parallelFor(0, numChunks, 1, [&] (int chunk) {
+            CurveIntersector<Point, Scalar> intersector(tolerance);
+            std::vector<CurveIntersection<Scalar>> found;
+
+            int end = std::min(numPairs, (chunk + 1) * grainSize);
+            for (int pairIdx = chunk * grainSize; pairIdx < end; ++pairIdx)
+            {
+                int first = pairs[pairIdx].first, second = pairs[pairIdx].second;
+
+                found.clear();
+                intersector(curves[first], curves[second], std::back_inserter(found));
+
+                for (const CurveIntersection<Scalar> &intersection : found)
+                    chunkResults[chunk].push_back(
+                        CurvePairIntersection<Scalar> { first, second, intersection.t, intersection.u });
+            }
+        });
+
+        std::vector<CurvePairIntersection<Scalar>> result;
+        for (const std::vector<CurvePairIntersection<Scalar>> &chunk : chunkResults)
+            result.insert(result.end(), chunk.begin(), chunk.end());
+        return result;
+    }
+
+}
+
+#endif // INTERSECTION_H
@@ -0,0 +1,192 @@
+#ifndef BEZIER_LANES_H
+#define BEZIER_LANES_H
+
+/*
+    Lane-parallel inner loops shared by the batched entry points in
+    deCasteljau.h. A "lane" is one independent run of the de Casteljau
+    recurrence on the same control polygon. Lanes are interleaved in the
+    scratch buffer (point `pointIdx` of lane `lane` lives at
+    `pointIdx * lanes + lane`), so the innermost loop performs the same
+    affine combination on adjacent Points and can be vectorized by the
+    compiler without knowing anything about the Point type.
+
+    On x86 with GCC or Clang, the kernel is compiled several times with
+    different target attributes and picked at runtime based on the CPU.
+    Everywhere else (including NEON, which is baseline on AArch64) the
+    generic build of the kernel is used.
+
+    Results agree with the scalar algorithms up to floating-point rounding
+    (the wider backends may contract a multiply and an add into an FMA).
+
+    The kernels are plain C++ that the compiler vectorizes, with no
+    intrinsics. Points of two or four coordinates (see useLanes) gain
+    from them; to get the full width of the vector units, store the polygon
+    as a ControlPolygonSoA.
+*/
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CAGD_BEZIER_X86_DISPATCH 1
+#endif
+
+#if defined(__GNUC__)
+#define CAGD_BEZIER_ALWAYS_INLINE __attribute__((always_inline)) inline
+#elif defined(_MSC_VER)
+#define CAGD_BEZIER_ALWAYS_INLINE __forceinline
+#else
+#define CAGD_BEZIER_ALWAYS_INLINE inline
+#endif
+
+// GCC only runs its cheapest vectorizer at -O2, which gives up on the lane
+// loop; ask for the full one on the kernels. Clang vectorizes at -O2 anyway.
+#if defined(__GNUC__) && !defined(__clang__)
+#define CAGD_BEZIER_VECTORIZE __attribute__((optimize("tree-vectorize")))
+#else
+#define CAGD_BEZIER_VECTORIZE
+#endif
+
+namespace Geometry::Bezier::detail
+{
+
+    /**
+        @brief The largest number of lanes any kernel below uses.
+    */
+    constexpr int MaxLanes = 16;
+
+    /**
+        @brief Runs `Lanes` de Casteljau recurrences side by side.
+
+        `scratch` holds `numPoints * Lanes` interleaved points and is
+        overwritten; the results end up in `scratch[0...Lanes-1]`.
+
+        The parameter used by lane `lane` in iteration `iteration` (counting
+        from 1) is `params[(iteration - 1) * paramStride + lane]`. A stride
+        of 0 gives the plain de Casteljau algorithm, a stride of `Lanes`
+        gives the blossom.
+    */
+    template< int Lanes, typename Point, typename Param >
+    CAGD_BEZIER_ALWAYS_INLINE void lanesKernel(int numPoints, const Param *params,
+                                               int paramStride, Point *scratch)
+    {
+        for (int iteration = 1; iteration < numPoints; ++iteration)
+        {
+            const Param *t = params + (iteration - 1) * paramStride;
+
+            for (int pointIdx = 0; pointIdx < numPoints - iteration; ++pointIdx)
+            {
+                Point *p1 = scratch + pointIdx * Lanes;
+                const Point *p2 = p1 + Lanes;
+
+                for (int lane = 0; lane < Lanes; ++lane)
+                    p1[lane] = p1[lane] + t[lane] * (p2[lane] - p1[lane]);
+            }
+        }
+    }
+
+    template< int Lanes, typename Point, typename Param >
+    CAGD_BEZIER_VECTORIZE
+    inline void lanesKernelGeneric(int numPoints, const Param *params, int paramStride, Point *scratch)
+    {
+        lanesKernel<Lanes>(numPoints, params, paramStride, scratch);
+    }
+
+#ifdef CAGD_BEZIER_X86_DISPATCH
+    template< int Lanes, typename Point, typename Param >
+    __attribute__((target("avx2"))) CAGD_BEZIER_VECTORIZE
+    inline void lanesKernelAvx2(int numPoints, const Param *params, int paramStride, Point *scratch)
+    {
+        lanesKernel<Lanes>(numPoints, params, paramStride, scratch);
+    }
+
+    template< int Lanes, typename Point, typename Param >
+    __attribute__((target("avx512f"))) CAGD_BEZIER_VECTORIZE
+    inline void lanesKernelAvx512(int numPoints, const Param *params, int paramStride, Point *scratch)
+    {
+        lanesKernel<Lanes>(numPoints, params, paramStride, scratch);
+    }
+#endif
+
+    /**
+        @brief Instruction sets that the lane kernels are built for.
+    */
+    enum class LaneBackend
+    {
+        Generic,
+        Avx2,
+        Avx512
+    };
+
+    /**
+        @brief Picks the best backend for the CPU we are running on. The result
+        is computed once and cached.
+    */
+    inline LaneBackend laneBackend()
+    {
+#ifdef CAGD_BEZIER_X86_DISPATCH
+        static const LaneBackend backend = [] {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f"))
+                return LaneBackend::Avx512;
+            if (__builtin_cpu_supports("avx2"))
+                return LaneBackend::Avx2;
+            return LaneBackend::Generic;
+        }();
+        return backend;
+#else
+        return LaneBackend::Generic;
+#endif
+    }
+
+    /**
+        @brief Number of lanes the selected backend processes at once. This is
+        the layout that runLanes() expects its scratch buffer to be in.
+    */
+    inline int laneCount()
+    {
+        switch (laneBackend())
+        {
+        case LaneBackend::Avx512: return 16;
+        case LaneBackend::Avx2: return 8;
+        default: return 4;
+        }
+    }
+
+    /**
+        @brief Whether the batched entry points run Points of this type in
+        lanes, which they do when the Point's size is a power of two, so that
+        interleaved Points tile vector registers evenly.
+
+        Other Points straddle registers. For three floats or doubles, the
+        kernels were measured to be no faster than running the recurrences
+        one after the other (0.85 to 1.0 times the speed on AVX-512, degrees
+        3 to 32), so such Points run the scalar algorithm once per parameter
+        instead. To evaluate them in SIMD lanes, use a ControlPolygonSoA,
+        whose kernels run on coordinate arrays.
+    */
+    template< typename Point >
+    constexpr bool useLanes = (sizeof(Point) & (sizeof(Point) - 1)) == 0;
+
+    /**
+        @brief Runs lanesKernel() with `laneCount()` lanes on the best backend.
+    */
+    template< typename Point, typename Param >
+    inline void runLanes(int numPoints, const Param *params, int paramStride, Point *scratch)
+    {
+        switch (laneBackend())
+        {
+#ifdef CAGD_BEZIER_X86_DISPATCH
+        case LaneBackend::Avx512:
+            lanesKernelAvx512<16>(numPoints, params, paramStride, scratch);
+            break;
+        case LaneBackend::Avx2:
+            lanesKernelAvx2<8>(numPoints, params, paramStride, scratch);
+            break;
+#endif
+        default:
+            lanesKernelGeneric<4>(numPoints, params, paramStride, scratch);
+            break;
+        }
+    }
+
+}
+
+#endif // BEZIER_LANES_H
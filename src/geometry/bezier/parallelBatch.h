@@ -0,0 +1,117 @@
+#ifndef PARALLEL_BATCH_H
+#define PARALLEL_BATCH_H
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cstddef>
+
+#include "deCasteljau.h"
+#include "forwardDifferencing.h"
+#include "controlPolygonSoA.h"
+#include "../../concurrency/workStealingPool.h"
+
+namespace Geometry::Bezier
+{
+
+    /*
+        Batch versions of the algorithms in this namespace that process a whole
+        collection of independent control polygons on a WorkStealingPool.
+
+        Outputs go to a caller-provided random-access iterator (for example the
+        begin() of a preallocated std::vector), laid out contiguously in the
+        order of the polygons. Polygons are handed to the pool in chunks of
+        `grainSize`. Scratch memory is never allocated per output point:
+        subdivideBatch() allocates once per chunk, deCasteljauBatch() once per
+        polygon, and tessellateBatch() O(degree) times per polygon, for the
+        hodographs and difference table that tessellateUniform() sets up.
+
+        The pool is used rather than std::execution::par since the latter
+        needs TBB with libstdc++ and cannot be given a fixed number of threads.
+        How these functions scale with the number of threads has not been
+        measured yet: the BM_*BatchParallel benchmarks have only run on a
+        single core, so nothing here is known to beat a loop on one thread.
+
+        Parameters are of type `Scalar` as in deCasteljau.h: the value type of
+        `params`, or float (unless given explicitly) for the others.
+    */
+
+    /**
+        @brief Evaluates every polygon at every parameter in `params`. The point
+        of polygon `c` at `params[k]` is written to `out[c * params.size() + k]`.
+    */
+    template< typename Point, typename Scalar, typename RandomAccessIterator >
+    inline void deCasteljauBatch(Concurrency::WorkStealingPool &pool,
+                                 const std::vector<std::vector<Point>> &polygons,
+                                 const std::vector<Scalar> &params,
+                                 RandomAccessIterator out, int grainSize = 64)
+    {
+        int numParams = params.size();
+
+        pool.parallelFor(0, polygons.size(), grainSize, [&] (int c) {
+            deCasteljau(polygons[c], params.begin(), params.end(), out + std::ptrdiff_t(c) * numParams);
+        });
+    }
+
+
+    /**
+        @brief Finds for every polygon the polygon that maps [0,1] to its [t0,t1]
+        part, as the vector-returning subdivide() does. The new polygons are
+        written one after the other to `out`; that is, the new polygon of
+        `polygons[c]` starts at `out[offset]`, where `offset` is the sum of the
+        sizes of the polygons before it.
+    */
+    template< typename Scalar = float, typename Point, typename RandomAccessIterator >
+    inline void subdivideBatch(Concurrency::WorkStealingPool &pool,
+                               const std::vector<std::vector<Point>> &polygons,
+                               detail::NonDeduced<Scalar> t0, detail::NonDeduced<Scalar> t1,
+                               RandomAccessIterator out, int grainSize = 64)
+    {
+        int numPolygons = polygons.size();
+
+        std::vector<std::ptrdiff_t> offsets(numPolygons + 1, 0);
+        for (int c = 0; c < numPolygons; ++c)
+            offsets[c + 1] = offsets[c] + polygons[c].size();
+
+        // Chunks rather than parallelFor()'s own grain, so that each chunk
+        // shares one workspace; clamped as parallelFor() clamps it.
+        grainSize = std::max(1, grainSize);
+        int numChunks = (numPolygons + grainSize - 1) / grainSize;
+
+        pool.parallelFor(0, numChunks, 1, [&] (int chunk) {
+            DeCasteljauWorkspace<Point> workspace;
+
+            int end = std::min(numPolygons, (chunk + 1) * grainSize);
+            for (int c = chunk * grainSize; c < end; ++c)
+            {
+                int numPoints = polygons[c].size();
+
+                DeCasteljauScheme<Point, typename DeCasteljauWorkspace<Point>::SchemeAllocator>
+                    scheme(polygons[c], workspace.schemeAllocator(numPoints));
+
+                detail::subdivideScheme<Scalar>(scheme, numPoints, t0, t1, out + offsets[c]);
+            }
+        });
+    }
+
+
+    /**
+        @brief Samples every polygon at `numSteps + 1` uniformly spaced
+        parameters with tessellateUniform(). The samples of polygon `c` are
+        written to `out[c * (numSteps + 1)]` onwards.
+    */
+    template< typename Point, typename RandomAccessIterator >
+    inline void tessellateBatch(Concurrency::WorkStealingPool &pool,
+                                const std::vector<std::vector<Point>> &polygons,
+                                int numSteps, RandomAccessIterator out,
+                                int resyncInterval = 0, int grainSize = 64)
+    {
+        pool.parallelFor(0, polygons.size(), grainSize, [&] (int c) {
+            tessellateUniform(polygons[c], numSteps, out + std::ptrdiff_t(c) * (numSteps + 1),
+                              resyncInterval);
+        });
+    }
+
+}
+
+#endif // PARALLEL_BATCH_H
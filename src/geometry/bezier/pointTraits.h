@@ -0,0 +1,67 @@
+#ifndef POINT_TRAITS_H
+#define POINT_TRAITS_H
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief Describes the coordinates of a Point type.
+
+        The algorithms in deCasteljau.h only need affine combinations of points,
+        but anything that looks at individual coordinates (such as the
+        structure-of-arrays polygon in controlPolygonSoA.h) needs this trait to
+        be specialized for the Point type. A specialization must provide:
+
+            static constexpr int Dimension;           // number of coordinates
+            typedef <...> Scalar;                     // type of one coordinate
+            static Scalar coordinate(const Point &p, int d);   // 0 <= d < Dimension
+
+        Specializations for float and double (one-dimensional points) are
+        provided below.
+    */
+    template< typename Point >
+    struct PointTraits;
+
+    template<>
+    struct PointTraits<float>
+    {
+        static constexpr int Dimension = 1;
+        typedef float Scalar;
+
+        static Scalar coordinate(float p, int) { return p; }
+    };
+
+    template<>
+    struct PointTraits<double>
+    {
+        static constexpr int Dimension = 1;
+        typedef double Scalar;
+
+        static Scalar coordinate(double p, int) { return p; }
+    };
+
+
+    namespace detail
+    {
+
+        template< typename T >
+        struct NonDeducedImpl
+        {
+            typedef T type;
+        };
+
+        /**
+            @brief Names `T` such that it is not deduced from a function
+            argument. The parameter `t` of `f(NonDeduced<Scalar> t)` takes its
+            type from the explicit template arguments of `f` (or their
+            defaults), so any value convertible to Scalar, such as an integer
+            literal, can be passed.
+        */
+        template< typename T >
+        using NonDeduced = typename NonDeducedImpl<T>::type;
+
+    }
+
+}
+
+#endif // POINT_TRAITS_H
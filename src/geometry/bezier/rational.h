@@ -0,0 +1,282 @@
+#ifndef RATIONAL_H
+#define RATIONAL_H
+
+#include <array>
+#include <vector>
+#include <iterator>
+#include <utility>
+#include <cassert>
+
+#include "controlPolygonSoA.h"
+#include "pointTraits.h"
+
+namespace Geometry::Bezier
+{
+
+    /*
+        A rational Bezier curve of degree n with control points b_i and
+        weights w_i is
+            x(t) = sum_i w_i b_i B_i^n(t) / sum_i w_i B_i^n(t),
+        the central projection of the polynomial curve with the homogeneous
+        control points (w_i b_i, w_i) in one dimension more. Conic sections are
+        rational quadratics, and the pieces of NURBS are rational curves.
+
+        So everything here runs the polynomial algorithms of
+        controlPolygonSoA.h, including its SIMD lanes, on the homogeneous
+        polygon, and divides by the weight only once per point that is
+        returned. The weights must be positive, which keeps the curve in the
+        convex hull of its control points and the denominator away from 0.
+    */
+
+    /**
+        @brief A rational control polygon of `Dim`-dimensional points, stored
+        as a structure of arrays of homogeneous coordinates: the weighted
+        coordinates w_i b_i first, then the weights w_i as coordinate `Dim`.
+    */
+    template< int Dim, typename Scalar = float >
+    class RationalPolygonSoA
+    {
+    public:
+        typedef Scalar ScalarType;
+        typedef ControlPolygonSoA<Dim + 1, Scalar> Homogeneous;
+
+        static constexpr int Dimension = Dim;
+
+        explicit RationalPolygonSoA(int numPoints = 0)
+            : mHomogeneous(numPoints)
+        {
+            for (int idx = 0; idx < numPoints; ++idx)
+                mHomogeneous(Dim, idx) = 1;
+        }
+
+        /**
+            @brief Takes over a polygon of homogeneous coordinates, whose last
+            coordinate array holds the weights.
+        */
+        explicit RationalPolygonSoA(Homogeneous homogeneous)
+            : mHomogeneous(std::move(homogeneous))
+        {
+        }
+
+        /**
+            @brief Builds the polygon of control points `points` with weights
+            `weights`. PointTraits<Point> must be specialized and have
+            `Dimension == Dim`.
+        */
+        template< typename Point >
+        static RationalPolygonSoA fromPoints(const std::vector<Point> &points, const std::vector<Scalar> &weights)
+        {
+            static_assert( PointTraits<Point>::Dimension == Dim,
+                           "Point dimension does not match the polygon" );
+            assert( points.size() == weights.size() );
+
+            RationalPolygonSoA polygon(points.size());
+            for (int idx = 0; idx < polygon.size(); ++idx)
+            {
+                std::array<Scalar, Dim> p;
+                for (int d = 0; d < Dim; ++d)
+                    p[d] = PointTraits<Point>::coordinate(points[idx], d);
+                polygon.setPoint(idx, p, weights[idx]);
+            }
+
+            return polygon;
+        }
+
+        /**
+            @brief The number of points in the polygon.
+        */
+        int size() const
+        {
+            return mHomogeneous.size();
+        }
+
+        Scalar weight(int idx) const
+        {
+            return mHomogeneous(Dim, idx);
+        }
+
+        /**
+            @brief The `idx`th control point, divided by its weight.
+        */
+        std::array<Scalar, Dim> point(int idx) const
+        {
+            std::array<Scalar, Dim> p;
+            for (int d = 0; d < Dim; ++d)
+                p[d] = mHomogeneous(d, idx) / weight(idx);
+            return p;
+        }
+
+        void setPoint(int idx, const std::array<Scalar, Dim> &p, Scalar weight)
+        {
+            assert( weight > 0 );
+
+            for (int d = 0; d < Dim; ++d)
+                mHomogeneous(d, idx) = weight * p[d];
+            mHomogeneous(Dim, idx) = weight;
+        }
+
+        /**
+            @brief Changes the weight of the `idx`th control point, keeping the
+            point itself.
+        */
+        void setWeight(int idx, Scalar weight)
+        {
+            setPoint(idx, point(idx), weight);
+        }
+
+        const Homogeneous &homogeneous() const
+        {
+            return mHomogeneous;
+        }
+
+        ControlPolygonSoAView<Dim + 1, Scalar> view() const
+        {
+            return mHomogeneous.view();
+        }
+
+    private:
+        Homogeneous mHomogeneous;
+    };
+
+
+    namespace detail
+    {
+
+        /**
+            @brief The point with homogeneous coordinates `p`.
+        */
+        template< std::size_t Dim, typename Scalar >
+        inline std::array<Scalar, Dim - 1> dehomogenize(const std::array<Scalar, Dim> &p)
+        {
+            Scalar inverse = 1 / p[Dim - 1];
+
+            std::array<Scalar, Dim - 1> result;
+            for (std::size_t d = 0; d + 1 < Dim; ++d)
+                result[d] = p[d] * inverse;
+            return result;
+        }
+
+        /**
+            @brief An output iterator that takes homogeneous points and writes
+            the points they stand for to `OutputIterator`.
+        */
+        template< typename OutputIterator >
+        class DehomogenizingIterator
+        {
+        public:
+            typedef std::output_iterator_tag iterator_category;
+            typedef void value_type;
+            typedef void difference_type;
+            typedef void pointer;
+            typedef void reference;
+
+            explicit DehomogenizingIterator(OutputIterator out)
+                : mOut(out) {}
+
+            template< std::size_t Dim, typename Scalar >
+            DehomogenizingIterator &operator= (const std::array<Scalar, Dim> &p)
+            {
+                *mOut = dehomogenize(p);
+                ++mOut;
+                return *this;
+            }
+
+            DehomogenizingIterator &operator* () { return *this; }
+            DehomogenizingIterator &operator++ () { return *this; }
+            DehomogenizingIterator &operator++ (int) { return *this; }
+
+            OutputIterator base() const
+            {
+                return mOut;
+            }
+
+        private:
+            OutputIterator mOut;
+        };
+
+    }
+
+
+    /**
+        @brief The point of a rational curve at parameter t: the homogeneous
+        de Casteljau algorithm, one coordinate array at a time, and a single
+        division.
+    */
+    template< int Dim, typename Scalar >
+    inline std::array<Scalar, Dim> deCasteljau(const RationalPolygonSoA<Dim, Scalar> &polygon,
+                                               detail::NonDeduced<Scalar> t)
+    {
+        return detail::dehomogenize(deCasteljau(polygon.view(), t));
+    }
+
+
+    /**
+        @brief Evaluates a rational curve once for every parameter in
+        [firstParam, lastParam), writing one std::array<Scalar, Dim> per
+        parameter to `out`. This is the batched SoA deCasteljau() on the
+        homogeneous polygon, with the same SIMD lanes, followed by one division
+        per point.
+
+        Returns the output iterator one past the last point written.
+    */
+    template< int Dim, typename Scalar, typename ParamIterator, typename OutputIterator >
+    inline OutputIterator deCasteljau(const RationalPolygonSoA<Dim, Scalar> &polygon,
+                                      ParamIterator firstParam, ParamIterator lastParam,
+                                      OutputIterator out)
+    {
+        return deCasteljau(polygon.view(), firstParam, lastParam,
+                           detail::DehomogenizingIterator<OutputIterator>(out)).base();
+    }
+
+
+    /**
+        @brief Finds the rational polygon that maps [0,1] to the [t0,t1] part
+        of `polygon`'s curve, by subdividing the homogeneous polygon. The
+        weights of the result are the last coordinates of the new homogeneous
+        points, so no division is needed.
+    */
+    template< int Dim, typename Scalar >
+    inline RationalPolygonSoA<Dim, Scalar> subdivide(const RationalPolygonSoA<Dim, Scalar> &polygon,
+                                                     detail::NonDeduced<Scalar> t0,
+                                                     detail::NonDeduced<Scalar> t1)
+    {
+        return RationalPolygonSoA<Dim, Scalar>(subdivide(polygon.view(), t0, t1));
+    }
+
+
+    /**
+        @brief Splits a rational curve at parameter t, returning the polygons of
+        the [0,t] and [t,1] parts.
+    */
+    template< int Dim, typename Scalar >
+    inline std::pair<RationalPolygonSoA<Dim, Scalar>, RationalPolygonSoA<Dim, Scalar>>
+    split(const RationalPolygonSoA<Dim, Scalar> &polygon, detail::NonDeduced<Scalar> t)
+    {
+        auto halves = split(polygon.view(), t);
+        return { RationalPolygonSoA<Dim, Scalar>(std::move(halves.first)),
+                 RationalPolygonSoA<Dim, Scalar>(std::move(halves.second)) };
+    }
+
+
+    /**
+        @brief The rational quadratic of the conic arc from `p0` to `p2` whose
+        tangents at the ends meet at `p1`. The middle weight `w` picks the
+        conic: an ellipse for w < 1, a parabola for w = 1 and a hyperbola for
+        w > 1. A circular arc of angle 2a has w = cos(a), and its middle point
+        at the intersection of the tangents.
+    */
+    template< int Dim, typename Scalar >
+    inline RationalPolygonSoA<Dim, Scalar> conicArc(const std::array<Scalar, Dim> &p0,
+                                                    const std::array<Scalar, Dim> &p1,
+                                                    const std::array<Scalar, Dim> &p2, Scalar w)
+    {
+        RationalPolygonSoA<Dim, Scalar> polygon(3);
+        polygon.setPoint(0, p0, 1);
+        polygon.setPoint(1, p1, w);
+        polygon.setPoint(2, p2, 1);
+        return polygon;
+    }
+
+}
+
+#endif // RATIONAL_H
@@ -0,0 +1,265 @@
+#ifndef STRIDED_VIEW_H
+#define STRIDED_VIEW_H
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <cstddef>
+#include <cassert>
+
+#include "deCasteljau.h"
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief A non-owning view of `size()` points that are `stride()` bytes
+        apart in memory, such as the positions in an interleaved vertex buffer.
+
+        The points must be actual Point objects (for example, members of the
+        vertex structs in the buffer). A StridedView<Point> converts to a
+        StridedView<const Point>, and views are cheap to copy. A std::vector
+        converts to a view of all its points.
+
+        The overloads of deCasteljau(), blossom(), subdivide() and split() below
+        read the control points through a view and write their results through
+        output views or iterators, so that points in external buffers can be
+        processed without first copying them into a std::vector. They still
+        need scratch memory, which comes from a DeCasteljauWorkspace.
+    */
+    template< typename Point >
+    class StridedView
+    {
+        typedef std::conditional_t<std::is_const<Point>::value, const std::byte, std::byte> Byte;
+
+    public:
+        typedef std::remove_const_t<Point> value_type;
+
+        /**
+            @brief A random-access iterator over the points of a view.
+        */
+        class iterator
+        {
+        public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef std::remove_const_t<Point> value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef Point *pointer;
+            typedef Point &reference;
+
+            iterator() = default;
+
+            iterator(Byte *position, std::ptrdiff_t stride)
+                : mPosition(position), mStride(stride) {}
+
+            reference operator*() const { return *reinterpret_cast<Point *>(mPosition); }
+            pointer operator->() const { return reinterpret_cast<Point *>(mPosition); }
+            reference operator[](difference_type n) const { return *(*this + n); }
+
+            iterator &operator++() { mPosition += mStride; return *this; }
+            iterator &operator--() { mPosition -= mStride; return *this; }
+            iterator operator++(int) { iterator old = *this; ++*this; return old; }
+            iterator operator--(int) { iterator old = *this; --*this; return old; }
+
+            iterator &operator+=(difference_type n) { mPosition += n * mStride; return *this; }
+            iterator &operator-=(difference_type n) { mPosition -= n * mStride; return *this; }
+            iterator operator+(difference_type n) const { return iterator(mPosition + n * mStride, mStride); }
+            iterator operator-(difference_type n) const { return iterator(mPosition - n * mStride, mStride); }
+            friend iterator operator+(difference_type n, const iterator &it) { return it + n; }
+
+            difference_type operator-(const iterator &other) const
+            {
+                return (mPosition - other.mPosition) / mStride;
+            }
+
+            bool operator==(const iterator &other) const { return mPosition == other.mPosition; }
+            bool operator!=(const iterator &other) const { return mPosition != other.mPosition; }
+            bool operator<(const iterator &other) const { return mPosition < other.mPosition; }
+            bool operator>(const iterator &other) const { return mPosition > other.mPosition; }
+            bool operator<=(const iterator &other) const { return mPosition <= other.mPosition; }
+            bool operator>=(const iterator &other) const { return mPosition >= other.mPosition; }
+
+        private:
+            Byte *mPosition = nullptr;
+            std::ptrdiff_t mStride = sizeof(Point);
+        };
+
+        /**
+            @brief A view of `size` points, the first of which is at `first`,
+            `stride` bytes apart. The default stride gives a plain array.
+        */
+        StridedView(Point *first, int size, std::ptrdiff_t stride = sizeof(Point))
+            : mFirst(reinterpret_cast<Byte *>(first)),
+              mSize(size),
+              mStride(stride)
+        {
+            assert( stride > 0 );
+        }
+
+        /**
+            @brief A view of all points in `points`.
+        */
+        template< typename Allocator >
+        StridedView(std::vector<value_type, Allocator> &points)
+            : StridedView(points.data(), points.size()) {}
+
+        template< typename Allocator >
+        StridedView(const std::vector<value_type, Allocator> &points)
+            : StridedView(points.data(), points.size()) {}
+
+        /**
+            @brief A read-only view of the points of a mutable one.
+        */
+        template< typename Other,
+                  typename = std::enable_if_t<std::is_same<const Other, Point>::value &&
+                                              !std::is_same<Other, Point>::value> >
+        StridedView(const StridedView<Other> &other)
+            : StridedView(other.data(), other.size(), other.stride()) {}
+
+        /**
+            @brief The first point.
+        */
+        Point *data() const
+        {
+            return reinterpret_cast<Point *>(mFirst);
+        }
+
+        int size() const
+        {
+            return mSize;
+        }
+
+        /**
+            @brief The distance between two consecutive points, in bytes.
+        */
+        std::ptrdiff_t stride() const
+        {
+            return mStride;
+        }
+
+        Point &operator[] (int idx) const
+        {
+            return *reinterpret_cast<Point *>(mFirst + idx * mStride);
+        }
+
+        iterator begin() const
+        {
+            return iterator(mFirst, mStride);
+        }
+
+        iterator end() const
+        {
+            return iterator(mFirst + mSize * mStride, mStride);
+        }
+
+    private:
+        Byte *mFirst;
+        int mSize;
+        std::ptrdiff_t mStride;
+    };
+
+
+    /**
+        @brief Performs the de Casteljau algorithm with parameter t on the
+        points of a view, using the scratch memory of `workspace`.
+    */
+    template< typename Scalar = float, typename Point >
+    inline std::remove_const_t<Point> deCasteljau(StridedView<Point> points, detail::NonDeduced<Scalar> t,
+                                                  DeCasteljauWorkspace<std::remove_const_t<Point>> &workspace)
+    {
+        return deCasteljau<Scalar>(workspace.load(points.begin(), points.end()), points.size(), t);
+    }
+
+
+    /**
+        @brief Performs the batched deCasteljau() of deCasteljau.h on the
+        points of a view. `out` may be the begin() of an output view.
+    */
+    template< typename Point, typename ParamIterator, typename OutputIterator >
+    inline OutputIterator deCasteljau(StridedView<Point> points,
+                                      ParamIterator firstParam, ParamIterator lastParam,
+                                      OutputIterator out)
+    {
+        return detail::deCasteljauLanes<std::remove_const_t<Point>>(points, points.size(),
+                                                                    firstParam, lastParam, out);
+    }
+
+
+    /**
+        @brief Computes the blossom of the points of a view, using the scratch
+        memory of `workspace`. params.size() must be points.size() - 1.
+    */
+    template< typename Scalar = float, typename Point >
+    inline std::remove_const_t<Point> blossom(StridedView<Point> points,
+                                              const std::vector<detail::NonDeduced<Scalar>> &params,
+                                              DeCasteljauWorkspace<std::remove_const_t<Point>> &workspace)
+    {
+        assert( int(params.size()) == points.size() - 1 );
+
+        return blossom<Scalar>(workspace.load(points.begin(), points.end()), points.size(), params.data());
+    }
+
+
+    /**
+        @brief Performs the batched blossom() of deCasteljau.h on the points of
+        a view.
+    */
+    template< typename Point, typename ParamsIterator, typename OutputIterator >
+    inline OutputIterator blossom(StridedView<Point> points,
+                                  ParamsIterator firstParams, ParamsIterator lastParams,
+                                  OutputIterator out)
+    {
+        return detail::blossomLanes<std::remove_const_t<Point>>(points, points.size(),
+                                                                firstParams, lastParams, out);
+    }
+
+
+    /**
+        @brief Finds the control polygon that maps [0,1] to the [t0,t1] part of
+        the curve of the points of a view, like the vector-returning
+        subdivide() in deCasteljau.h, and writes it to `newPoints`, which must
+        have room for points.size() points. The scheme is allocated from
+        `workspace`'s arena.
+    */
+    template< typename Scalar = float, typename Point, typename NewPoint >
+    inline void subdivide(StridedView<Point> points,
+                          detail::NonDeduced<Scalar> t0, detail::NonDeduced<Scalar> t1,
+                          StridedView<NewPoint> newPoints,
+                          DeCasteljauWorkspace<std::remove_const_t<Point>> &workspace)
+    {
+        typedef std::remove_const_t<Point> Value;
+
+        assert( newPoints.size() >= points.size() );
+
+        DeCasteljauScheme<Value, typename DeCasteljauWorkspace<Value>::SchemeAllocator>
+            scheme(points.begin(), points.end(), workspace.schemeAllocator(points.size()));
+
+        detail::subdivideScheme<Scalar>(scheme, points.size(), t0, t1, newPoints.begin());
+    }
+
+
+    /**
+        @brief Splits the curve of the points of a view at parameter t, writing
+        the control polygons of the [0,t] and [t,1] parts to `left` and
+        `right`, which must each have room for points.size() points.
+        `right` may be a view of the same points as `points`, to split in place.
+        This is the in-place split() of deCasteljau.h, run on `right`.
+    */
+    template< typename Scalar = float, typename Point, typename LeftPoint, typename RightPoint >
+    inline void split(StridedView<Point> points, detail::NonDeduced<Scalar> t,
+                      StridedView<LeftPoint> left, StridedView<RightPoint> right)
+    {
+        int numPoints = points.size();
+
+        assert( left.size() >= numPoints && right.size() >= numPoints );
+
+        if (right.data() != points.data())
+            std::copy(points.begin(), points.end(), right.begin());
+
+        detail::splitInPlace<Scalar>(right, numPoints, t, left);
+    }
+
+}
+
+#endif // STRIDED_VIEW_H
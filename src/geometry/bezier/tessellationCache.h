@@ -0,0 +1,424 @@
+#ifndef TESSELLATION_CACHE_H
+#define TESSELLATION_CACHE_H
+
+#include <array>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cassert>
+
+#include "controlPolygonSoA.h"
+#include "adaptiveTessellation.h"
+#include "../../concurrency/workStealingPool.h"
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief Polylines of a collection of curves at several levels of
+        detail, tessellated on a thread pool and read by a renderer without
+        waiting for it.
+
+        Level l approximates every curve to within `tolerance(l)`, which is
+        the finest tolerance times 2^l, with uniformSegmentCount() segments. A
+        renderer asks for the tolerance of its current view (for example, half
+        a pixel in curve coordinates) and gets the level just fine enough for
+        it, so zooming by up to a factor of two reuses the same polylines, and
+        zooming back finds the old ones still there.
+
+        Curves are identified by their index, in the order they are added.
+        Every change to a curve gives it a new version, and a polyline
+        remembers the version it was made from, so a cached polyline is
+        current when its version is the curve's. request() queues work only
+        for the curves whose polyline at the wanted level is missing or out of
+        date, and only once per version, so across frames of a static scene it
+        costs one comparison per curve.
+
+        The polylines are made on the pool, in batches of `batchSize` curves,
+        and published one at a time by atomically replacing a
+        std::shared_ptr, so a reader always sees either the old polyline or
+        the new one, complete, and keeps whatever it holds alive by itself.
+        Until the current polyline arrives, polyline() falls back to the
+        nearest other level, and then to an out-of-date polyline, so nothing
+        disappears while it is being redone.
+
+        Everything, polyline() and isCurrent() included, belongs to one
+        thread (the GUI thread), which owns the slots, the polygons and the
+        versions; the pool only ever touches copies of the polygons and the
+        published polylines, which are the only state shared between the
+        threads. A polyline that polyline() has returned may be handed to
+        any thread, since it never changes.
+
+        A polyline keeps its vertices in a `Vertices`, which is reserved and
+        then filled through std::back_inserter() with Vertex values, so a
+        renderer can have them made in the form it draws (a QPolygonF, say)
+        on the pool rather than convert them on every frame.
+    */
+    template< int Dim, typename Scalar = float, typename Vertices = std::vector<std::array<Scalar, Dim>> >
+    class TessellationCache
+    {
+    public:
+        typedef ControlPolygonSoA<Dim, Scalar> Polygon;
+        typedef std::array<Scalar, Dim> Vertex;
+
+        /**
+            @brief The vertices approximating one version of a curve at one
+            level, from t = 0 to t = 1.
+        */
+        struct Polyline
+        {
+            std::uint64_t version;
+            int level;
+            Vertices vertices;
+        };
+
+        static constexpr int MaxLevels = 16;
+
+        TessellationCache(Concurrency::WorkStealingPool &pool, Scalar finestTolerance, int numLevels = 8,
+                          int maxSegments = 1024, int batchSize = 256)
+            : mPool(pool),
+              mFinestTolerance(finestTolerance),
+              mNumLevels(numLevels),
+              mMaxSegments(maxSegments),
+              mBatchSize(batchSize)
+        {
+            assert( finestTolerance > 0 );
+            assert( numLevels >= 1 && numLevels <= MaxLevels );
+        }
+
+        /**
+            @brief Waits for the queued work, which refers to the cache.
+        */
+        ~TessellationCache()
+        {
+            wait();
+        }
+
+        TessellationCache(const TessellationCache &) = delete;
+        TessellationCache &operator=(const TessellationCache &) = delete;
+
+        /**
+            @brief Sets a function to be called on a pool thread every time a
+            batch of polylines has been published, for example to schedule a
+            repaint. Set it before the first request().
+        */
+        void setReadyCallback(std::function<void()> callback)
+        {
+            mReadyCallback = std::move(callback);
+        }
+
+        /**
+            @brief The number of curves, including removed ones.
+        */
+        int size() const
+        {
+            return mSlots.size();
+        }
+
+        int numLevels() const
+        {
+            return mNumLevels;
+        }
+
+        /**
+            @brief The tolerance of the `level`th level.
+        */
+        Scalar tolerance(int level) const
+        {
+            return std::ldexp(mFinestTolerance, level);
+        }
+
+        /**
+            @brief The coarsest level whose tolerance is at most `tolerance`,
+            or the finest level if there is none.
+        */
+        int levelFor(Scalar tolerance) const
+        {
+            int level = 0;
+            while (level + 1 < mNumLevels && this->tolerance(level + 1) <= tolerance)
+                ++level;
+            return level;
+        }
+
+        /**
+            @brief Adds a curve, returning its index.
+        */
+        int addCurve(Polygon polygon)
+        {
+            mSlots.emplace_back();
+            int curveIdx = size() - 1;
+            setCurve(curveIdx, std::move(polygon));
+            return curveIdx;
+        }
+
+        /**
+            @brief Replaces the `curveIdx`th curve, making its polylines out of
+            date.
+        */
+        void setCurve(int curveIdx, Polygon polygon)
+        {
+            assert( polygon.size() >= 1 );
+
+            Slot &slot = mSlots[curveIdx];
+            slot.polygon = std::make_shared<const Polygon>(std::move(polygon));
+            slot.version = ++mLastVersion;
+        }
+
+        /**
+            @brief Removes the `curveIdx`th curve. Its index is not reused.
+
+            Its polylines are replaced by an empty tombstone of the removal
+            version, so that jobs still in flight for it, being older, cannot
+            publish into the slot again.
+        */
+        void removeCurve(int curveIdx)
+        {
+            Slot &slot = mSlots[curveIdx];
+            slot.polygon.reset();
+            slot.version = ++mLastVersion;
+
+            auto tombstone = std::make_shared<const Polyline>(Polyline { slot.version, Removed, Vertices() });
+            for (auto &polyline : slot.polylines)
+                std::atomic_store(&polyline, tombstone);
+        }
+
+        bool contains(int curveIdx) const
+        {
+            return mSlots[curveIdx].polygon != nullptr;
+        }
+
+        /**
+            @brief The `curveIdx`th curve, which must not have been removed.
+        */
+        const Polygon &curve(int curveIdx) const
+        {
+            return *mSlots[curveIdx].polygon;
+        }
+
+        std::uint64_t version(int curveIdx) const
+        {
+            return mSlots[curveIdx].version;
+        }
+
+        /**
+            @brief Queues the tessellation at levelFor(`tolerance`) of the curves
+            in [firstCurve, lastCurve) whose polyline there is out of date and
+            not already queued. Returns the number of curves queued.
+        */
+        template< typename CurveIterator >
+        int request(CurveIterator firstCurve, CurveIterator lastCurve, Scalar tolerance)
+        {
+            int level = levelFor(tolerance);
+
+            std::vector<Job> jobs;
+            int numQueued = 0;
+
+            for (; firstCurve != lastCurve; ++firstCurve)
+            {
+                Slot &slot = mSlots[*firstCurve];
+                if (!slot.polygon || slot.requested[level] == slot.version)
+                    continue;
+
+                slot.requested[level] = slot.version;
+
+                auto published = std::atomic_load(&slot.polylines[level]);
+                if (published && published->version == slot.version)
+                    continue;
+
+                jobs.push_back(Job { &slot, slot.polygon, slot.version });
+                ++numQueued;
+
+                if (int(jobs.size()) == mBatchSize)
+                {
+                    submit(std::move(jobs), level);
+                    jobs.clear();
+                }
+            }
+
+            if (!jobs.empty())
+                submit(std::move(jobs), level);
+
+            return numQueued;
+        }
+
+        /**
+            @brief request() for every curve.
+        */
+        int request(Scalar tolerance)
+        {
+            std::vector<int> curves(size());
+            for (int curveIdx = 0; curveIdx < size(); ++curveIdx)
+                curves[curveIdx] = curveIdx;
+            return request(curves.begin(), curves.end(), tolerance);
+        }
+
+        /**
+            @brief The best polyline there is for drawing the `curveIdx`th
+            curve at `tolerance`: the current polyline at levelFor(`tolerance`)
+            if it is ready, otherwise the current polyline of the nearest level
+            (finer first), otherwise the out-of-date polyline of the nearest
+            level, and null if the curve has none yet or has been removed.
+        */
+        std::shared_ptr<const Polyline> polyline(int curveIdx, Scalar tolerance) const
+        {
+            const Slot &slot = mSlots[curveIdx];
+            if (!slot.polygon)
+                return nullptr;
+
+            int level = levelFor(tolerance);
+            std::shared_ptr<const Polyline> stale;
+
+            for (int distance = 0; distance < mNumLevels; ++distance)
+            {
+                for (int candidate : { level - distance, level + distance })
+                {
+                    if (candidate < 0 || candidate >= mNumLevels)
+                        continue;
+
+                    auto published = std::atomic_load(&slot.polylines[candidate]);
+                    if (!published || published->level == Removed)
+                        continue;
+                    if (published->version == slot.version)
+                        return published;
+                    if (!stale)
+                        stale = std::move(published);
+                }
+            }
+
+            return stale;
+        }
+
+        /**
+            @brief Whether the `curveIdx`th curve's polyline for `tolerance` is
+            ready and current.
+        */
+        bool isCurrent(int curveIdx, Scalar tolerance) const
+        {
+            auto published = polyline(curveIdx, tolerance);
+            return published && published->version == version(curveIdx)
+                   && published->level == levelFor(tolerance);
+        }
+
+        /**
+            @brief Blocks until all the queued work has been published.
+        */
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(mPendingMutex);
+            mPendingDone.wait(lock, [this] { return mPending == 0; });
+        }
+
+    private:
+        // The level of a removed curve's tombstones.
+        static constexpr int Removed = -1;
+
+        struct Slot
+        {
+            // Shared with the queued jobs; a change replaces it, so jobs never
+            // see a polygon change under them.
+            std::shared_ptr<const Polygon> polygon;
+            std::uint64_t version = 0;
+
+            // The version last queued for each level, so that a curve is not
+            // queued again every frame while its polyline is being made.
+            std::array<std::uint64_t, MaxLevels> requested {};
+
+            // Only accessed through std::atomic_load() and friends.
+            std::array<std::shared_ptr<const Polyline>, MaxLevels> polylines;
+        };
+
+        struct Job
+        {
+            Slot *slot;
+            std::shared_ptr<const Polygon> polygon;
+            std::uint64_t version;
+        };
+
+        void submit(std::vector<Job> jobs, int level)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mPendingMutex);
+                ++mPending;
+            }
+
+            mPool.submit([this, jobs = std::move(jobs), level] {
+                run(jobs, level);
+
+                if (mReadyCallback)
+                    mReadyCallback();
+
+                std::lock_guard<std::mutex> lock(mPendingMutex);
+                if (--mPending == 0)
+                    mPendingDone.notify_all();
+            });
+        }
+
+        void run(const std::vector<Job> &jobs, int level) const
+        {
+            Scalar levelTolerance = tolerance(level);
+
+            std::vector<Scalar> params;
+            for (const Job &job : jobs)
+            {
+                int numSegments = uniformSegmentCount(job.polygon->view(), levelTolerance, mMaxSegments);
+
+                params.resize(numSegments + 1);
+                for (int k = 0; k <= numSegments; ++k)
+                    params[k] = Scalar(k) / Scalar(numSegments);
+
+                auto result = std::make_shared<Polyline>();
+                result->version = job.version;
+                result->level = level;
+                result->vertices.reserve(params.size());
+                deCasteljau(job.polygon->view(), params.begin(), params.end(),
+                            std::back_inserter(result->vertices));
+
+                publish(job.slot->polylines[level], std::move(result));
+            }
+        }
+
+        /**
+            @brief Stores `result` in `target` unless a polyline of a later
+            version got there first; jobs for two versions of a curve may
+            finish in either order.
+        */
+        static void publish(std::shared_ptr<const Polyline> &target, std::shared_ptr<const Polyline> result)
+        {
+            auto current = std::atomic_load(&target);
+            while (!current || current->version < result->version)
+            {
+                if (std::atomic_compare_exchange_weak(&target, &current, result))
+                    break;
+            }
+        }
+
+        Concurrency::WorkStealingPool &mPool;
+        Scalar mFinestTolerance;
+        int mNumLevels;
+        int mMaxSegments;
+        int mBatchSize;
+
+        // A deque, so that the slots the queued jobs point to stay put as
+        // curves are added.
+        std::deque<Slot> mSlots;
+        // 64 bits, so that it never wraps around and an old polyline never
+        // passes for a current one.
+        std::uint64_t mLastVersion = 0;
+
+        std::function<void()> mReadyCallback;
+
+        std::mutex mPendingMutex;
+        std::condition_variable mPendingDone;
+        int mPending = 0;
+    };
+
+}
+
+#endif // TESSELLATION_CACHE_H
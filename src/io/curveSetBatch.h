@@ -0,0 +1,35 @@
+#ifndef CURVE_SET_BATCH_H
+#define CURVE_SET_BATCH_H
+
+#include <vector>
+#include <cstddef>
+
+#include "curveSetFile.h"
+#include "../concurrency/workStealingPool.h"
+
+namespace Geometry::Bezier
+{
+
+    /**
+        @brief Evaluates every curve of a (typically memory-mapped) curve-set
+        file at every parameter in `params`, in place in the file's memory, like
+        deCasteljauBatch() in parallelBatch.h. The point of curve `c` at
+        `params[k]` is written to `out[c * params.size() + k]` as a
+        std::array<Scalar, Dim>.
+    */
+    template< int Dim, typename Scalar, typename RandomAccessIterator >
+    inline void deCasteljauBatch(Concurrency::WorkStealingPool &pool,
+                                 const IO::CurveSetView<Dim, Scalar> &curves,
+                                 const std::vector<Scalar> &params,
+                                 RandomAccessIterator out, int grainSize = 64)
+    {
+        int numParams = params.size();
+
+        pool.parallelFor(0, curves.size(), grainSize, [&] (int c) {
+            deCasteljau(curves.curve(c), params.begin(), params.end(), out + std::ptrdiff_t(c) * numParams);
+        });
+    }
+
+}
+
+#endif // CURVE_SET_BATCH_H
@@ -0,0 +1,584 @@
+#ifndef CURVE_SET_FILE_H
+#define CURVE_SET_FILE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../geometry/bezier/controlPolygonSoA.h"
+#include "../geometry/bezier/pointTraits.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CAGD_IO_HAVE_MMAP 1
+#endif
+
+namespace IO
+{
+
+    /*
+        A binary container for a set of Bezier control polygons of the same
+        dimension and scalar type, which can be memory-mapped and used in place.
+
+        The file consists of
+            - a CurveSetHeader at offset 0,
+            - an index of `numCurves` CurveSetIndexEntry records at `indexOffset`,
+            - the payload at `payloadOffset`, a multiple of 64 bytes.
+
+        The payload holds one block per curve, at the offset given in the index
+        (relative to the payload and a multiple of 64 bytes). The block of a
+        polygon of n + 1 points consists of `Dim` coordinate arrays of
+        `ControlPolygonSoA<Dim, Scalar>::paddedSize(n + 1)` scalars each,
+        padded with zeros. That is exactly the memory layout of a
+        ControlPolygonSoA, so a block is used as a ControlPolygonSoAView without
+        any parsing, and is read into a ControlPolygonSoA with a single read.
+
+        Numbers are stored in the byte order of the machine that wrote the
+        file; the header records it, and files from a machine with the other
+        byte order are rejected.
+    */
+
+    /**
+        @brief The first 64 bytes of a curve-set file.
+    */
+    struct CurveSetHeader
+    {
+        char magic[8];                  // "CAGDBEZ\0"
+        std::uint32_t version;          // 1
+        std::uint32_t byteOrder;        // 0x01020304, as written by the machine
+        std::uint32_t dimension;        // coordinates per point
+        std::uint32_t scalarSize;       // 4 for float, 8 for double
+        std::uint32_t alignment;        // 64
+        std::uint32_t reserved;
+        std::uint64_t numCurves;
+        std::uint64_t indexOffset;      // from the start of the file, in bytes
+        std::uint64_t payloadOffset;    // from the start of the file, in bytes
+        std::uint64_t payloadSize;      // in bytes
+    };
+
+    static_assert( sizeof(CurveSetHeader) == 64, "CurveSetHeader must not be padded" );
+
+
+    /**
+        @brief The entry of one curve in the index of a curve-set file.
+    */
+    struct CurveSetIndexEntry
+    {
+        std::uint32_t degree;
+        std::uint32_t reserved;
+        std::uint64_t offset;           // from the start of the payload, in bytes
+    };
+
+    static_assert( sizeof(CurveSetIndexEntry) == 16, "CurveSetIndexEntry must not be padded" );
+
+
+    /**
+        @brief Thrown when a curve-set file is malformed, or does not have the
+        dimension or scalar type it is read as.
+    */
+    class CurveSetError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+
+    namespace detail
+    {
+
+        constexpr char CurveSetMagic[8] = { 'C', 'A', 'G', 'D', 'B', 'E', 'Z', '\0' };
+        constexpr std::uint32_t CurveSetVersion = 1;
+        constexpr std::uint32_t CurveSetByteOrder = 0x01020304;
+        constexpr std::uint64_t CurveSetAlignment = 64;
+
+        inline std::uint64_t roundUp(std::uint64_t n, std::uint64_t alignment)
+        {
+            return ((n + alignment - 1) / alignment) * alignment;
+        }
+
+        /**
+            @brief The size in bytes of the block of a polygon of `numPoints`
+            points.
+        */
+        template< int Dim, typename Scalar >
+        std::uint64_t blockSize(int numPoints)
+        {
+            static_assert( Geometry::Bezier::ControlPolygonSoA<Dim, Scalar>::Alignment == CurveSetAlignment,
+                           "Curve-set blocks must have the layout of ControlPolygonSoA" );
+
+            return std::uint64_t(Dim) * Geometry::Bezier::ControlPolygonSoA<Dim, Scalar>::paddedSize(numPoints)
+                   * sizeof(Scalar);
+        }
+
+        /**
+            @brief Throws CurveSetError unless `header` describes a file of
+            `Dim`-dimensional points with coordinates of type `Scalar`.
+        */
+        template< int Dim, typename Scalar >
+        void checkHeader(const CurveSetHeader &header)
+        {
+            static_assert( std::is_floating_point<Scalar>::value, "Scalar must be float or double" );
+
+            if (std::memcmp(header.magic, CurveSetMagic, sizeof(CurveSetMagic)) != 0)
+                throw CurveSetError("not a curve-set file");
+            if (header.byteOrder != CurveSetByteOrder)
+                throw CurveSetError("curve-set file has a different byte order");
+            if (header.version != CurveSetVersion)
+                throw CurveSetError("unsupported curve-set file version " + std::to_string(header.version));
+            if (header.dimension != Dim)
+                throw CurveSetError("curve-set file has dimension " + std::to_string(header.dimension)
+                                    + ", expected " + std::to_string(Dim));
+            if (header.scalarSize != sizeof(Scalar))
+                throw CurveSetError("curve-set file has " + std::to_string(header.scalarSize)
+                                    + "-byte scalars, expected " + std::to_string(sizeof(Scalar)));
+            if (header.alignment != CurveSetAlignment || header.payloadOffset % CurveSetAlignment != 0)
+                throw CurveSetError("curve-set file is not aligned");
+        }
+
+        /**
+            @brief Throws CurveSetError unless the index and the payload that
+            `header` describes lie within a file of `size` bytes.
+        */
+        inline void checkBounds(const CurveSetHeader &header, std::uint64_t size)
+        {
+            if (header.indexOffset % alignof(CurveSetIndexEntry) != 0 ||
+                header.indexOffset > size ||
+                header.numCurves > (size - header.indexOffset) / sizeof(CurveSetIndexEntry) ||
+                header.payloadOffset > size || header.payloadSize > size - header.payloadOffset)
+                throw CurveSetError("curve-set file is truncated");
+        }
+
+        /**
+            @brief Throws CurveSetError unless the block of `entry` lies within
+            a payload of `payloadSize` bytes.
+        */
+        template< int Dim, typename Scalar >
+        void checkEntry(const CurveSetIndexEntry &entry, std::uint64_t payloadSize)
+        {
+            if (entry.degree >= std::uint32_t(1) << 24 || entry.offset % CurveSetAlignment != 0 ||
+                entry.offset > payloadSize ||
+                blockSize<Dim, Scalar>(entry.degree + 1) > payloadSize - entry.offset)
+                throw CurveSetError("curve-set index entry is out of bounds");
+        }
+
+    }
+
+
+    /**
+        @brief Curve-set file contents in memory (typically a MappedFile),
+        giving access to each curve as a ControlPolygonSoAView without copying.
+
+        The header and the bounds of the index are checked on construction,
+        and the bounds of a curve's block whenever it is accessed. `data` must
+        be aligned to at least alignof(Scalar), and should be aligned to 64
+        bytes (as mapped memory is) for aligned vector loads.
+    */
+    template< int Dim, typename Scalar = float >
+    class CurveSetView
+    {
+    public:
+        typedef Geometry::Bezier::ControlPolygonSoAView<Dim, Scalar> CurveView;
+
+        CurveSetView(const void *data, std::size_t size)
+            : mData(static_cast<const std::byte *>(data)),
+              mSize(size)
+        {
+            if (size < sizeof(CurveSetHeader))
+                throw CurveSetError("curve-set file is truncated");
+            if (reinterpret_cast<std::uintptr_t>(data) % alignof(Scalar) != 0)
+                throw CurveSetError("curve-set data is not aligned");
+
+            std::memcpy(&mHeader, mData, sizeof(CurveSetHeader));
+            detail::checkHeader<Dim, Scalar>(mHeader);
+            detail::checkBounds(mHeader, size);
+
+            mIndex = mData + mHeader.indexOffset;
+        }
+
+        const CurveSetHeader &header() const
+        {
+            return mHeader;
+        }
+
+        /**
+            @brief The number of curves in the set.
+        */
+        std::size_t size() const
+        {
+            return mHeader.numCurves;
+        }
+
+        int degree(std::size_t curveIdx) const
+        {
+            return entry(curveIdx).degree;
+        }
+
+        /**
+            @brief The start of the payload, which holds the blocks of all
+            curves in `header().payloadSize` bytes, for handing to an API that
+            wants the whole payload at once (such as a GPU buffer upload).
+        */
+        const std::byte *payload() const
+        {
+            return mData + mHeader.payloadOffset;
+        }
+
+        /**
+            @brief The control polygon of the `curveIdx`th curve, pointing into
+            the file's memory.
+        */
+        CurveView curve(std::size_t curveIdx) const
+        {
+            CurveSetIndexEntry entry = this->entry(curveIdx);
+            detail::checkEntry<Dim, Scalar>(entry, mHeader.payloadSize);
+
+            int numPoints = entry.degree + 1;
+            const Scalar *block = reinterpret_cast<const Scalar *>(mData + mHeader.payloadOffset + entry.offset);
+
+            return CurveView(block, numPoints,
+                             Geometry::Bezier::ControlPolygonSoA<Dim, Scalar>::paddedSize(numPoints));
+        }
+
+    private:
+        /**
+            @brief Copies out the index entry of the `curveIdx`th curve. `data`
+            need only be aligned for Scalar, which may be less than the
+            alignment of the entry's 64-bit offset.
+        */
+        CurveSetIndexEntry entry(std::size_t curveIdx) const
+        {
+            CurveSetIndexEntry result;
+            std::memcpy(&result, mIndex + curveIdx * sizeof(CurveSetIndexEntry), sizeof(CurveSetIndexEntry));
+            return result;
+        }
+
+        const std::byte *mData;
+        std::size_t mSize;
+
+        CurveSetHeader mHeader;
+        const std::byte *mIndex;
+    };
+
+
+#ifdef CAGD_IO_HAVE_MMAP
+    /**
+        @brief A read-only memory mapping of a whole file, unmapped on
+        destruction. Throws std::system_error if the file cannot be mapped.
+    */
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::string &path)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+
+            struct stat status;
+            if (::fstat(fd, &status) != 0)
+            {
+                int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "cannot stat " + path);
+            }
+
+            mSize = status.st_size;
+
+            if (mSize > 0)
+            {
+                mData = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mData == MAP_FAILED)
+                {
+                    int error = errno;
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), "cannot map " + path);
+                }
+            }
+
+            // The mapping stays valid after the descriptor is closed.
+            ::close(fd);
+        }
+
+        ~MappedFile()
+        {
+            if (mData)
+                ::munmap(mData, mSize);
+        }
+
+        MappedFile(MappedFile &&other)
+            : mData(other.mData), mSize(other.mSize)
+        {
+            other.mData = nullptr;
+            other.mSize = 0;
+        }
+
+        MappedFile &operator=(MappedFile &&other)
+        {
+            std::swap(mData, other.mData);
+            std::swap(mSize, other.mSize);
+            return *this;
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const void *data() const
+        {
+            return mData;
+        }
+
+        std::size_t size() const
+        {
+            return mSize;
+        }
+
+    private:
+        void *mData = nullptr;
+        std::size_t mSize = 0;
+    };
+#endif
+
+
+    /**
+        @brief Reads the curves of a curve-set file one at a time from a
+        stream, for files that do not fit in memory (or cannot be mapped).
+
+        Only a chunk of the index and one curve are held in memory at a time.
+        The stream must be opened in binary mode and be seekable, and the
+        file must end where the stream does. Throws CurveSetError if the file
+        is malformed or cannot be read.
+    */
+    template< int Dim, typename Scalar = float >
+    class CurveSetReader
+    {
+    public:
+        /**
+            @brief The number of index entries read from the stream at once.
+        */
+        static constexpr std::size_t IndexChunk = 4096;
+
+        explicit CurveSetReader(std::istream &stream)
+            : mStream(stream)
+        {
+            read(&mHeader, sizeof(CurveSetHeader));
+            detail::checkHeader<Dim, Scalar>(mHeader);
+
+            // Bounding the file by its real size, rather than by the sizes in
+            // its header, keeps a malformed index from making next() allocate
+            // a block that the stream does not have.
+            if (!mStream.seekg(0, std::ios::end))
+                throw CurveSetError("cannot seek in curve-set file");
+            std::streamoff size = mStream.tellg();
+            if (size < 0)
+                throw CurveSetError("cannot seek in curve-set file");
+            detail::checkBounds(mHeader, size);
+
+            mPayloadPosition = mHeader.payloadOffset;
+            mIndexChunk.reserve(IndexChunk);
+        }
+
+        const CurveSetHeader &header() const
+        {
+            return mHeader;
+        }
+
+        /**
+            @brief The number of curves in the set.
+        */
+        std::size_t size() const
+        {
+            return mHeader.numCurves;
+        }
+
+        /**
+            @brief Reads the next curve into `polygon`, reusing its memory.
+            Returns false, leaving `polygon` unchanged, after the last curve.
+        */
+        bool next(Geometry::Bezier::ControlPolygonSoA<Dim, Scalar> &polygon)
+        {
+            if (mNextCurve == mHeader.numCurves)
+                return false;
+
+            if (mNextCurve == mIndexChunkStart + mIndexChunk.size())
+                readIndexChunk();
+
+            const CurveSetIndexEntry &entry = mIndexChunk[mNextCurve - mIndexChunkStart];
+            detail::checkEntry<Dim, Scalar>(entry, mHeader.payloadSize);
+
+            std::uint64_t position = mHeader.payloadOffset + entry.offset;
+            if (position != mPayloadPosition)
+                seek(position);
+
+            std::uint64_t bytes = detail::blockSize<Dim, Scalar>(entry.degree + 1);
+
+            polygon.resize(entry.degree + 1);
+            read(polygon.coordinates(0), bytes);
+
+            mPayloadPosition = position + bytes;
+            ++mNextCurve;
+            return true;
+        }
+
+    private:
+        void readIndexChunk()
+        {
+            mIndexChunkStart = mNextCurve;
+
+            std::size_t count = std::min<std::uint64_t>(IndexChunk, mHeader.numCurves - mNextCurve);
+            mIndexChunk.resize(count);
+
+            seek(mHeader.indexOffset + mNextCurve * sizeof(CurveSetIndexEntry));
+            read(mIndexChunk.data(), count * sizeof(CurveSetIndexEntry));
+            seek(mPayloadPosition);
+        }
+
+        void seek(std::uint64_t position)
+        {
+            if (!mStream.seekg(position))
+                throw CurveSetError("cannot seek in curve-set file");
+        }
+
+        void read(void *data, std::uint64_t bytes)
+        {
+            if (!mStream.read(static_cast<char *>(data), bytes))
+                throw CurveSetError("curve-set file is truncated");
+        }
+
+        std::istream &mStream;
+        CurveSetHeader mHeader;
+
+        std::uint64_t mNextCurve = 0;
+        std::uint64_t mPayloadPosition;
+
+        std::vector<CurveSetIndexEntry> mIndexChunk;
+        std::uint64_t mIndexChunkStart = 0;
+    };
+
+
+    namespace detail
+    {
+
+        /**
+            @brief Writes the header, the index and the padding before the
+            payload of a curve-set file of `numCurves` curves, the `c`th of
+            which has `numPoints(c)` points. The blocks of the curves must
+            follow in order.
+        */
+        template< int Dim, typename Scalar, typename NumPoints >
+        void writeCurveSetIndex(std::ostream &stream, std::uint64_t numCurves, NumPoints numPoints)
+        {
+            CurveSetHeader header = {};
+            std::memcpy(header.magic, CurveSetMagic, sizeof(CurveSetMagic));
+            header.version = CurveSetVersion;
+            header.byteOrder = CurveSetByteOrder;
+            header.dimension = Dim;
+            header.scalarSize = sizeof(Scalar);
+            header.alignment = CurveSetAlignment;
+            header.numCurves = numCurves;
+            header.indexOffset = sizeof(CurveSetHeader);
+            header.payloadOffset = roundUp(header.indexOffset + numCurves * sizeof(CurveSetIndexEntry),
+                                           CurveSetAlignment);
+
+            std::vector<CurveSetIndexEntry> index(numCurves);
+            std::uint64_t offset = 0;
+            for (std::uint64_t c = 0; c < numCurves; ++c)
+            {
+                int size = numPoints(c);
+                assert( size >= 1 );
+
+                index[c].degree = size - 1;
+                index[c].reserved = 0;
+                index[c].offset = offset;
+
+                // Blocks are multiples of 64 bytes, so every one stays aligned.
+                offset += blockSize<Dim, Scalar>(size);
+            }
+            header.payloadSize = offset;
+
+            std::vector<char> padding(header.payloadOffset - header.indexOffset - numCurves * sizeof(CurveSetIndexEntry), 0);
+
+            stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            stream.write(reinterpret_cast<const char *>(index.data()), numCurves * sizeof(CurveSetIndexEntry));
+            stream.write(padding.data(), padding.size());
+        }
+
+        template< int Dim, typename Scalar >
+        void writeCurveSetBlock(std::ostream &stream, const Geometry::Bezier::ControlPolygonSoA<Dim, Scalar> &polygon)
+        {
+            stream.write(reinterpret_cast<const char *>(polygon.coordinates(0)),
+                         blockSize<Dim, Scalar>(polygon.size()));
+        }
+
+    }
+
+
+    /**
+        @brief Writes `polygons` as a curve-set file to `stream`, which must be
+        opened in binary mode. Throws CurveSetError if writing fails.
+    */
+    template< int Dim, typename Scalar >
+    void writeCurveSet(std::ostream &stream,
+                       const std::vector<Geometry::Bezier::ControlPolygonSoA<Dim, Scalar>> &polygons)
+    {
+        detail::writeCurveSetIndex<Dim, Scalar>(stream, polygons.size(),
+                                                [&polygons](std::uint64_t c) { return polygons[c].size(); });
+
+        for (const Geometry::Bezier::ControlPolygonSoA<Dim, Scalar> &polygon : polygons)
+            detail::writeCurveSetBlock(stream, polygon);
+
+        if (!stream)
+            throw CurveSetError("cannot write curve-set file");
+    }
+
+
+    /**
+        @brief Converts control polygons of any Point type for which
+        PointTraits is specialized into a curve-set file, written to `stream`.
+
+        The polygons are converted one at a time, into the same buffer, as
+        they are written, so only one of them is ever held in both layouts.
+    */
+    template< typename Point >
+    void writeCurveSet(std::ostream &stream, const std::vector<std::vector<Point>> &polygons)
+    {
+        typedef Geometry::Bezier::PointTraits<Point> Traits;
+        constexpr int Dim = Traits::Dimension;
+        typedef typename Traits::Scalar Scalar;
+
+        detail::writeCurveSetIndex<Dim, Scalar>(stream, polygons.size(),
+                                                [&polygons](std::uint64_t c) { return int(polygons[c].size()); });
+
+        Geometry::Bezier::ControlPolygonSoA<Dim, Scalar> converted;
+        for (const std::vector<Point> &polygon : polygons)
+        {
+            // resize() zeroes the padding and keeps the memory of the largest
+            // polygon so far.
+            converted.resize(polygon.size());
+            for (int d = 0; d < Dim; ++d)
+                for (int idx = 0; idx < converted.size(); ++idx)
+                    converted(d, idx) = Traits::coordinate(polygon[idx], d);
+
+            detail::writeCurveSetBlock(stream, converted);
+        }
+
+        if (!stream)
+            throw CurveSetError("cannot write curve-set file");
+    }
+
+}
+
+#endif // CURVE_SET_FILE_H
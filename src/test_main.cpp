@@ -1,7 +1,42 @@
 #include "geometry/bezier/deCasteljau.h"
+#include "geometry/bezier/controlPolygonSoA.h"
+#include "geometry/bezier/fixedDegree.h"
+#include "geometry/bezier/hornerEvaluator.h"
+#include "geometry/bezier/forwardDifferencing.h"
+#include "geometry/bezier/adaptiveTessellation.h"
+#include "geometry/bezier/parallelBatch.h"
+#include "geometry/bezier/compensatedDeCasteljau.h"
+#include "geometry/bezier/blossomEvaluator.h"
+#include "geometry/bezier/cachedSampleCurve.h"
+#include "geometry/bezier/bezierCurve.h"
+#include "geometry/bezier/stridedView.h"
+#include "geometry/bezier/boundingBox.h"
+#include "geometry/bezier/curveBVH.h"
+#include "geometry/bezier/intersection.h"
+#include "geometry/bezier/projection.h"
+#include "geometry/bezier/arcLength.h"
+#include "geometry/bezier/instrumentation.h"
+#include "geometry/bezier/degreeElevation.h"
+#include "geometry/bezier/rational.h"
+#include "geometry/bezier/bezierPatch.h"
+#include "geometry/bezier/tessellationCache.h"
+#include "io/curveSetFile.h"
+#include "io/curveSetBatch.h"
+#include "concurrency/spscQueue.h"
+#include "concurrency/coalescingPipeline.h"
 
 
 #include <iostream>
+#include <iterator>
+#include <sstream>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 
 struct Vector3D
@@ -37,6 +72,33 @@ std::ostream &operator<<(std::ostream &stream, const Vector3D &vec)
     return stream << "(" << vec.x << ", " << vec.y << ", " << vec.z << ")";
 }
 
+std::ostream &operator<<(std::ostream &stream, const std::array<float, 3> &vec)
+{
+    return stream << "(" << vec[0] << ", " << vec[1] << ", " << vec[2] << ")";
+}
+
+template<>
+struct Geometry::Bezier::PointTraits<Vector3D>
+{
+    static constexpr int Dimension = 3;
+    typedef float Scalar;
+
+    static Scalar coordinate(const Vector3D &p, int d)
+    {
+        return d == 0 ? p.x : d == 1 ? p.y : p.z;
+    }
+};
+
+
+// The fixed-degree algorithms can run at compile time for literal Point types.
+constexpr std::array<float, 4> cubicScalars = {0, 1, 1, 0};
+static_assert( Geometry::Bezier::deCasteljau<3>(cubicScalars, 0.5f) == 0.75f,
+               "constexpr deCasteljau<3> failed" );
+static_assert( Geometry::Bezier::blossom<3>(cubicScalars, {0, 0, 1}) == 1.0f,
+               "constexpr blossom<3> failed" );
+static_assert( Geometry::Bezier::subdivide<3>(cubicScalars, 0, 0.5f)[3] == 0.75f,
+               "constexpr subdivide<3> failed" );
+
 
 int test_main()
 {
@@ -95,6 +157,569 @@ int test_main()
     cout << Bezier::deCasteljau(reparameterized, 1.4) << endl;
     cout << Bezier::deCasteljau(reparameterized, 2.0) << endl;
 
+    cout << "Batched deCasteljau on original points: the output must match the first test..." << endl;
+    vector<float> params = {0, 0.25, 0.7, 1};
+    vector<Vector3D> batch;
+    Bezier::deCasteljau(points, params.begin(), params.end(), back_inserter(batch));
+    for (const Vector3D &p : batch)
+        cout << p << endl;
+
+    cout << "Batched blossoming test: the output must match the subdivision above..." << endl;
+    vector<vector<float>> blossomParams = {
+        {0, 0, 0}, {0, 0, 0.5}, {0, 0.5, 0.5}, {0.5, 0.5, 0.5}
+    };
+    batch.clear();
+    Bezier::blossom(points, blossomParams.begin(), blossomParams.end(), back_inserter(batch));
+    for (const Vector3D &p : batch)
+        cout << p << endl;
+
+    cout << "Blossom evaluator test: must match the subdivision above (twice)..." << endl;
+    Bezier::BlossomEvaluator<Vector3D> blossomEvaluator(points);
+    Bezier::BlossomEvaluator<Vector3D> sortedEvaluator(points, Bezier::BlossomOrder::Sorted);
+    cout << blossomEvaluator({0, 0, 0}) << endl;
+    cout << blossomEvaluator({0, 0, 0.5}) << endl;
+    cout << blossomEvaluator({0, 0.5, 0.5}) << endl;
+    cout << blossomEvaluator({0.5, 0.5, 0.5}) << endl;
+    cout << sortedEvaluator({0, 0, 0}) << endl;
+    cout << sortedEvaluator({0.5, 0, 0}) << endl;
+    cout << sortedEvaluator({0.5, 0, 0.5}) << endl;
+    cout << sortedEvaluator({0.5, 0.5, 0.5}) << endl;
+
+    cout << "Workspace test: must match deCasteljau(0.7), blossom({0, 0.5, 0.5}) and subdivide(0, 0.5)..." << endl;
+    Bezier::DeCasteljauWorkspace<Vector3D> workspace;
+    cout << Bezier::deCasteljau(points, 0.7, workspace) << endl;
+    cout << Bezier::blossom(points, {0, 0.5, 0.5}, workspace) << endl;
+    Bezier::subdivide(points, 0, 0.5, workspace, batch);
+    for (const Vector3D &p : batch)
+        cout << p << endl;
+
+    cout << "Reusable scheme test: must match deCasteljau(0.7), subdivide(0, 0.5), then the original points..." << endl;
+    Bezier::DeCasteljauScheme<Vector3D> scheme(points);
+    cout << scheme.fill(0.7) << endl;
+    scheme.fill(0);
+    scheme.subdivide(0.5, ostream_iterator<Vector3D>(cout, "\n"));
+    scheme.subdivide(1, ostream_iterator<Vector3D>(cout, "\n"));
+    cout << "...after moving the last point to (2, 2, 2): subdivide(0, 0.5), then t = 0.7 twice..." << endl;
+    vector<Vector3D> moved = points;
+    moved[3] = Vector3D(2, 2, 2);
+    scheme.setPoint(3, moved[3], 0);
+    scheme.subdivide(0.5, ostream_iterator<Vector3D>(cout, "\n"));
+    scheme.reset(points);
+    scheme.fill(0.7);
+    cout << scheme.setPoint(3, moved[3], 0.7) << endl;
+    cout << Bezier::deCasteljau(moved, 0.7) << endl;
+
+    cout << "Cached sample test: after moving the last point to (2, 2, 2), must match deCasteljau" << endl
+         << "of the moved polygon at t = 0.0, 0.25, 0.7, 1.0..." << endl;
+    Bezier::CachedSampleCurve<Vector3D> cachedCurve(points, params);
+    cachedCurve.movePoint(3, moved[3]);
+    for (const Vector3D &p : cachedCurve.samples())
+        cout << p << endl;
+    for (float t : params)
+        cout << Bezier::deCasteljau(moved, t) << endl;
+
+    cout << "Curve derivatives test: position, first and second derivative at t = 0.7 in one pass," << endl
+         << "must match deCasteljau(0.7) and the hodographs at t = 0.7..." << endl;
+    Bezier::BezierCurve<Vector3D> curve(points);
+    Bezier::BezierCurve<Vector3D>::Derivatives derivatives = curve.derivatives(0.7);
+    cout << derivatives.position << endl
+         << derivatives.firstDerivative << endl
+         << derivatives.secondDerivative << endl;
+    cout << curve(0.7) << endl
+         << curve.derivative(0.7, 1) << endl
+         << curve.derivative(0.7, 2) << endl;
+    const Bezier::BezierCurve<Vector3D> &constCurve = curve;
+    Bezier::BezierCurve<Vector3D> copied = curve, rebuilt(points);
+    cout << "...the first derivative through a const reference, then whether a copy shares the version" << endl
+         << "while a curve made from the same points does not (must print 1 1)..." << endl;
+    cout << constCurve.derivative(0.7, 1) << endl;
+    cout << (copied.version() == curve.version()) << " " << (rebuilt.version() != curve.version()) << endl;
+
+    cout << "Strided view test: control points interleaved with other vertex data," << endl
+         << "must match deCasteljau(0.7), t = 0.0, 0.25, 0.7, 1.0 and subdivide(0, 0.5)..." << endl;
+    struct Vertex
+    {
+        Vector3D position;
+        int color;
+    };
+    vector<Vertex> vertices;
+    for (const Vector3D &p : points)
+        vertices.push_back(Vertex { p, 0 });
+    Bezier::StridedView<const Vector3D> view(&vertices[0].position, vertices.size(), sizeof(Vertex));
+    cout << Bezier::deCasteljau(view, 0.7, workspace) << endl;
+    Bezier::deCasteljau(view, params.begin(), params.end(), ostream_iterator<Vector3D>(cout, "\n"));
+    Bezier::StridedView<Vector3D> outView(&vertices[0].position, vertices.size(), sizeof(Vertex));
+    Bezier::subdivide(view, 0, 0.5, outView, workspace);
+    for (const Vertex &v : vertices)
+        cout << v.position << endl;
+
+    cout << "Fixed-degree test: must match deCasteljau(0.7), blossom({0, 0.5, 0.5}) and subdivide(0, 0.5)..." << endl;
+    array<Vector3D, 4> cubic = {points[0], points[1], points[2], points[3]};
+    cout << Bezier::deCasteljau<3>(cubic, 0.7) << endl;
+    cout << Bezier::blossom<3>(cubic, {0, 0.5, 0.5}) << endl;
+    for (const Vector3D &p : Bezier::subdivide<3>(cubic, 0, 0.5))
+        cout << p << endl;
+
+    cout << "Horner test (Bernstein, then power form): must match deCasteljau at t = 0.25, 0.7..." << endl;
+    Bezier::HornerEvaluator<Vector3D> bernstein(points);
+    Bezier::HornerEvaluator<Vector3D> power(points, Bezier::HornerBasis::Power);
+    cout << bernstein(0.25) << endl << bernstein(0.7) << endl;
+    cout << power(0.25) << endl << power(0.7) << endl;
+    cout << "...and with double parameters at t = 0.7..." << endl;
+    cout << Bezier::HornerEvaluator<Vector3D, double>(points)(0.7) << endl;
+
+    cout << "Forward differencing test: must match deCasteljau at t = 0, 0.25, 0.5, 0.75, 1 (twice)..." << endl;
+    batch.clear();
+    Bezier::tessellateUniform(points, 4, back_inserter(batch));
+    Bezier::tessellateUniform(points, 4, back_inserter(batch), 2);
+    for (const Vector3D &p : batch)
+        cout << p << endl;
+
+    cout << "Split test: must match subdivide(0, 0.5), then subdivide(0.5, 1)..." << endl;
+    auto halves = Bezier::split(points, 0.5);
+    for (const Vector3D &p : halves.first)
+        cout << p << endl;
+    for (const Vector3D &p : halves.second)
+        cout << p << endl;
+    for (const Vector3D &p : Bezier::subdivide(points, 0.5, 1))
+        cout << p << endl;
+
+    cout << "Adaptive tessellation test: a straight polygon gives 2 points, the original one more..." << endl;
+    vector<Vector3D> straight = {
+        Vector3D(0, 0, 0),
+        Vector3D(1, 1, 1),
+        Vector3D(2, 2, 2),
+        Vector3D(3, 3, 3)
+    };
+    batch.clear();
+    Bezier::tessellateAdaptive(straight, 0.01, back_inserter(batch));
+    cout << batch.size() << " points: " << batch.front() << " ... " << batch.back() << endl;
+    batch.clear();
+    Bezier::tessellateAdaptive(points, 0.01, back_inserter(batch));
+    cout << batch.size() << " points: " << batch.front() << " ... " << batch.back() << endl;
+
+    cout << "Parallel batch test: 100 copies of the curve, evaluated, subdivided and tessellated on 4 threads..." << endl;
+    Concurrency::WorkStealingPool pool(4);
+    vector<vector<Vector3D>> polygons(100, points);
+    vector<Vector3D> evaluated(polygons.size() * params.size(), points[0]);
+    vector<Vector3D> subdivided(polygons.size() * points.size(), points[0]);
+    vector<Vector3D> tessellated(polygons.size() * 5, points[0]);
+    Bezier::deCasteljauBatch(pool, polygons, params, evaluated.begin(), 8);
+    Bezier::subdivideBatch(pool, polygons, 0, 0.5, subdivided.begin(), 8);
+    Bezier::tessellateBatch(pool, polygons, 4, tessellated.begin(), 0, 8);
+    cout << "...t = 0.7 on the last curve: " << evaluated[99 * params.size() + 2] << endl;
+    cout << "...subdivide(0, 0.5) on the last curve:" << endl;
+    for (int idx = 0; idx < 4; ++idx)
+        cout << subdivided[99 * points.size() + idx] << endl;
+    cout << "...t = 0.75 on the last curve: " << tessellated[99 * 5 + 3] << endl;
+    vector<Vector3D> subdividedUnchunked(subdivided.size(), points[0]);
+    Bezier::subdivideBatch(pool, polygons, 0, 0.5, subdividedUnchunked.begin(), 0);
+    bool sameSubdivision = true;
+    for (std::size_t idx = 0; idx < subdivided.size(); ++idx)
+        sameSubdivision &= subdividedUnchunked[idx].x == subdivided[idx].x
+                           && subdividedUnchunked[idx].y == subdivided[idx].y
+                           && subdividedUnchunked[idx].z == subdivided[idx].z;
+    cout << "...subdivided with a grain size of 0, the same (must print 1): " << sameSubdivision << endl;
+
+    cout << "Structure-of-arrays test: deCasteljau with t = 0.0, 0.25, 0.7, 1.0 (batched)..." << endl;
+    auto soa = Bezier::ControlPolygonSoA<3>::fromPoints(points);
+    vector<array<float, 3>> soaBatch;
+    Bezier::deCasteljau(soa, params.begin(), params.end(), back_inserter(soaBatch));
+    for (const array<float, 3> &p : soaBatch)
+        cout << p << endl;
+
+    cout << "...blossom with {0, 0.5, 0.5}, then subdivide() with (0, 0.5)..." << endl;
+    cout << Bezier::blossom(soa, {0, 0.5, 0.5}) << endl;
+    auto soaReparameterized = Bezier::subdivide(soa, 0, 0.5);
+    for (int idx = 0; idx < soaReparameterized.size(); ++idx)
+        cout << soaReparameterized.point(idx) << endl;
+    cout << "...split() at 0.5 (right half)..." << endl;
+    auto soaHalves = Bezier::split(soa, 0.5);
+    for (int idx = 0; idx < soaHalves.second.size(); ++idx)
+        cout << soaHalves.second.point(idx) << endl;
+    cout << "...deCasteljau with new curve at t = 2.0" << endl;
+    cout << Bezier::deCasteljau(soaReparameterized, 2.0) << endl;
+    Bezier::ControlPolygonSoAWorkspace<float> soaWorkspace;
+    vector<array<float, 3>> soaWorkspaceBatch;
+    Bezier::deCasteljau(soa.view(), params.begin(), params.end(), back_inserter(soaWorkspaceBatch), soaWorkspace);
+    Bezier::ControlPolygonSoA<3> soaWorkspaceReparameterized;
+    Bezier::subdivide(soa.view(), 0, 0.5, soaWorkspace, soaWorkspaceReparameterized);
+    cout << "...the same through a workspace (must print 1 1 1 1): "
+         << (soaWorkspaceBatch == soaBatch) << " "
+         << (Bezier::deCasteljau(soa.view(), 0.7, soaWorkspace) == soaBatch[2]) << " "
+         << (Bezier::blossom(soa.view(), {0, 0.5, 0.5}, soaWorkspace) == Bezier::blossom(soa, {0, 0.5, 0.5})) << " "
+         << (soaWorkspaceReparameterized.point(3) == soaReparameterized.point(3)) << endl;
+
+    cout << "Precision test: double parameters and compensated evaluation must match deCasteljau(0.7)," << endl
+         << "then the compensated evaluation of the new curve at t = 2.0..." << endl;
+    cout << Bezier::deCasteljau<double>(points, 0.7) << endl;
+    cout << Bezier::compensatedDeCasteljau(points, 0.7) << endl;
+    cout << Bezier::compensatedDeCasteljau(soa, 0.7) << endl;
+    cout << Bezier::compensatedDeCasteljau(soaReparameterized, 2.0) << endl;
+
+    cout << "Curve-set file test: the curve and subdivide(0, 0.5) written and viewed in memory," << endl
+         << "must match deCasteljau with t = 0.7 on the first curve (batched), then on the new curve at t = 2.0," << endl
+         << "then its last control point read from the stream..." << endl;
+    stringstream file(ios::in | ios::out | ios::binary);
+    IO::writeCurveSet(file, vector<vector<Vector3D>> { points, Bezier::subdivide(points, 0, 0.5) });
+    string bytes = file.str();
+    vector<uint64_t> mapped((bytes.size() + 7) / 8);
+    memcpy(mapped.data(), bytes.data(), bytes.size());
+    IO::CurveSetView<3> curveSet(mapped.data(), bytes.size());
+    vector<array<float, 3>> fromFile(curveSet.size() * params.size());
+    Bezier::deCasteljauBatch(pool, curveSet, params, fromFile.begin());
+    cout << fromFile[2] << endl;
+    cout << Bezier::deCasteljau(curveSet.curve(1), 2.0) << endl;
+    IO::CurveSetReader<3> reader(file);
+    Bezier::ControlPolygonSoA<3> streamed;
+    int numStreamed = 0;
+    while (reader.next(streamed))
+        ++numStreamed;
+    cout << numStreamed << " curves, " << streamed.point(streamed.size() - 1) << endl;
+    vector<uint64_t> shifted((bytes.size() + 15) / 8);
+    memcpy(reinterpret_cast<char *>(shifted.data()) + 4, bytes.data(), bytes.size());
+    IO::CurveSetView<3> floatAligned(reinterpret_cast<char *>(shifted.data()) + 4, bytes.size());
+    stringstream truncated(bytes.substr(0, bytes.size() - 64), ios::in | ios::binary);
+    bool rejected = false;
+    try { IO::CurveSetReader<3> truncatedReader(truncated); } catch (const IO::CurveSetError &) { rejected = true; }
+    cout << "...the same viewed in memory aligned only for float, then a truncated file rejected by the reader"
+         << " (must print 1 1): " << (Bezier::deCasteljau(floatAligned.curve(1), 2.0) == Bezier::deCasteljau(curveSet.curve(1), 2.0))
+         << " " << rejected << endl;
+
+    cout << "Bounding box test: the box of the curve, the boxes of its halves from the scheme at 0.5" << endl
+         << "(must match the boxes of split(0.5)), then the curves near (3, 3, 3) and overlapping" << endl
+         << "[1.5, 2.5]^3 out of the curve, the straight polygon and the moved one (\"1\", then \"1 2\")..." << endl;
+    Bezier::BoundingBoxOf<Vector3D> box = Bezier::boundingBox(points);
+    cout << box.lower << " " << box.upper << endl;
+    scheme.reset(points);
+    scheme.fill(0.5);
+    auto halfBoxes = Bezier::splitBounds(scheme);
+    cout << halfBoxes.first.lower << " " << halfBoxes.first.upper << endl
+         << halfBoxes.second.lower << " " << halfBoxes.second.upper << endl;
+    Bezier::BoundingBoxCache<3> boxCache;
+    boxCache.push_back(points);
+    boxCache.push_back(straight);
+    boxCache.push_back(Bezier::BezierCurve<Vector3D>(moved));
+    vector<int> hits;
+    boxCache.near({3, 3, 3}, 0.5, back_inserter(hits));
+    for (int curveIdx : hits)
+        cout << curveIdx << " ";
+    cout << endl;
+    hits.clear();
+    boxCache.overlapping(Bezier::BoundingBox<3>({1.5, 1.5, 1.5}, {2.5, 2.5, 2.5}), back_inserter(hits));
+    for (int curveIdx : hits)
+        cout << curveIdx << " ";
+    cout << endl;
+    Bezier::BezierCurve<Vector3D> boxed(points);
+    int boxedIdx = boxCache.push_back(boxed);
+    boxed = Bezier::BezierCurve<Vector3D>(moved);
+    cout << "...refreshing a curve after another one has been assigned to it (must print 1 0): "
+         << boxCache.refresh(boxedIdx, boxed) << " " << boxCache.refresh(boxedIdx, boxed) << endl;
+
+    cout << "BVH test: the same three curves; the closest point to deCasteljau(0.7) (curve 0 near t = 0.7)," << endl
+         << "picking near (3, 3, 3.05) (curve 1 at t = 1, distance 0.05), nothing picked near (5, 5, 5)," << endl
+         << "then the curves in [1.5, 2.5]^3 before and after moving curve 2 back (\"1 2\", then \"1\")..." << endl;
+    Bezier::CurveBVH<Vector3D> bvh({points, straight, moved}, 0.001);
+    auto printHit = [] (const auto &hit) {
+        cout << "curve " << hit->curve << ", t = " << round(hit->t * 100) / 100
+             << ", distance " << round(hit->distance * 100) / 100 << endl;
+    };
+    printHit(bvh.closest(Bezier::deCasteljau(points, 0.7)));
+    printHit(bvh.pick(Vector3D(3, 3, 3.05), 0.1));
+    cout << (bvh.pick(Vector3D(5, 5, 5), 0.1) ? "picked" : "nothing") << endl;
+    hits.clear();
+    bvh.query(Bezier::BoundingBox<3>({1.5, 1.5, 1.5}, {2.5, 2.5, 2.5}), back_inserter(hits));
+    for (int curveIdx : hits)
+        cout << curveIdx << " ";
+    cout << endl;
+    bvh.setCurve(2, points);
+    hits.clear();
+    bvh.query(Bezier::BoundingBox<3>({1.5, 1.5, 1.5}, {2.5, 2.5, 2.5}), back_inserter(hits));
+    for (int curveIdx : hits)
+        cout << curveIdx << " ";
+    cout << endl;
+
+    cout << "Intersection test: the curve meets the straight polygon at (0, 0, 0) and (1, 1, 1)" << endl
+         << "(\"0 0\", \"1 0.33\"), the moved polygon meets it at (0, 0, 0) and (2, 2, 2) (\"0 0\", \"1 0.67\");" << endl
+         << "then all pairs of the three in parallel, one line per pair and intersection..." << endl;
+    vector<Bezier::CurveIntersection<float>> crossings;
+    Bezier::intersect(points, straight, 1e-4, back_inserter(crossings));
+    Bezier::CurveIntersector<Vector3D> intersector(1e-4);
+    intersector(moved, straight, back_inserter(crossings));
+    for (const auto &crossing : crossings)
+        cout << round(crossing.t * 100) / 100 << " " << round(crossing.u * 100) / 100 << endl;
+    for (const auto &crossing : Bezier::intersectBatch(pool, vector<vector<Vector3D>> {points, straight, moved}, 1e-4))
+        cout << crossing.first << " " << crossing.second << " "
+             << round(crossing.t * 100) / 100 << " " << round(crossing.u * 100) / 100 << endl;
+
+    cout << "Projection test: deCasteljau(0.7) projects to t = 0.7 at distance 0, (2, 2, 2) to the end" << endl
+         << "(t = 1, distance 1.73), (0.5, 0.5, 0.5) to t = 0.5 at distance 0.53; then the same, batched..." << endl;
+    Bezier::CurveProjector<Vector3D> projector(points);
+    vector<Vector3D> queries = { Bezier::deCasteljau(points, 0.7), Vector3D(2, 2, 2), Vector3D(0.5, 0.5, 0.5) };
+    vector<Bezier::Projection<Vector3D, float>> projections;
+    for (const Vector3D &q : queries)
+        projections.push_back(projector.project(q));
+    projector.project(queries.begin(), queries.end(), back_inserter(projections));
+    for (const auto &projection : projections)
+        cout << "t = " << round(projection.t * 100) / 100
+             << ", distance " << round(projection.distance * 100) / 100 << endl;
+
+
+    cout << "Arc-length test: must print 5.2 0.5 0.5, then 0 after the same curve and 1 after a change," << endl
+         << "then 1 and 100 after another curve has been assigned..." << endl;
+    Bezier::BezierCurve<Vector3D> walked(straight);
+    Bezier::ArcLengthTable<Vector3D> arcLength(walked);
+    cout << round(arcLength.length() * 100) / 100 << " "
+         << round(arcLength.parameter(arcLength.length() / 2) * 100) / 100 << " "
+         << round(arcLength.parameter(arcLength.length() / 2, 2) * 100) / 100 << endl;
+    cout << arcLength.refresh(walked) << endl;
+    walked.setPoint(3, Vector3D(2, 2, 2));
+    cout << arcLength.refresh(walked) << endl;
+    Bezier::BezierCurve<float> line({0, 1});
+    Bezier::ArcLengthTable<float> lineLength(line);
+    line = Bezier::BezierCurve<float>({0, 100});
+    cout << lineLength.refresh(line) << " " << round(lineLength.length()) << endl;
+
+
+    cout << "Instrumentation test: with CAGD_BEZIER_INSTRUMENTATION, must print 3 3 3 1 1; without it, 0 0 0 0 0..." << endl;
+    Bezier::resetInstrumentationStats();
+    Bezier::deCasteljau(points, 0.5);
+    Bezier::deCasteljau(points, 0.25, workspace);
+    Bezier::deCasteljau(soa, 0.5);
+    halves = Bezier::split(points, 0.5);
+    Bezier::split(Bezier::StridedView<const Vector3D>(points), 0.5,
+                  Bezier::StridedView<Vector3D>(halves.first), Bezier::StridedView<Vector3D>(halves.second));
+    Bezier::split(soa, 0.5);
+    Bezier::ControlPolygonSoAWorkspace<float> freshSoAWorkspace;
+    Bezier::subdivide(soa.view(), 0, 0.5, freshSoAWorkspace, soaWorkspaceReparameterized);
+    Bezier::InstrumentationStats stats = Bezier::instrumentationStats();
+    cout << stats[Bezier::InstrumentedFunction::DeCasteljau].calls << " "
+         << stats[Bezier::InstrumentedFunction::DeCasteljau].degrees[3] << " "
+         << stats[Bezier::InstrumentedFunction::Split].calls << " "
+         << stats[Bezier::InstrumentedFunction::Subdivide].calls << " "
+         << stats.allocations << endl;
+
+
+    cout << "Degree elevation test: must print 5 points, deCasteljau(0.7) twice, then 0 0 for how far the" << endl
+         << "reductions of the elevated polygons are from the original, the line from (0, 0, 0) to (3, 3, 3)," << endl
+         << "and the degrees 2 2..." << endl;
+    vector<Vector3D> elevated = Bezier::elevate(points, 1);
+    for (const Vector3D &p : elevated)
+        cout << p << " ";
+    cout << endl;
+    cout << Bezier::deCasteljau(points, 0.7) << " " << Bezier::deCasteljau(elevated, 0.7) << endl;
+    vector<Vector3D> reduced = Bezier::reduce(Bezier::elevate(points, 2), 3);
+    vector<Vector3D> reducedEnds = Bezier::reduce(elevated, 3, Bezier::ReductionEnds::Interpolated);
+    float reducedError = 0, reducedEndsError = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        reducedError = max(reducedError, abs(reduced[i].x - points[i].x) + abs(reduced[i].y - points[i].y)
+                                         + abs(reduced[i].z - points[i].z));
+        reducedEndsError = max(reducedEndsError, abs(reducedEnds[i].x - points[i].x)
+                                                 + abs(reducedEnds[i].y - points[i].y)
+                                                 + abs(reducedEnds[i].z - points[i].z));
+    }
+    cout << round(reducedError * 100) / 100 << " " << round(reducedEndsError * 100) / 100 << endl;
+    for (const Vector3D &p : Bezier::reduce(straight, 1))
+        cout << p << " ";
+    cout << endl;
+    vector<Bezier::ControlPolygonSoA<3, float>> mixed = { Bezier::ControlPolygonSoA<3, float>::fromPoints(points),
+                                                          Bezier::ControlPolygonSoA<3, float>::fromPoints(elevated) };
+    vector<Bezier::ControlPolygonSoA<3, float>> unified;
+    Bezier::changeDegree(mixed, 2, unified);
+    cout << unified[0].size() - 1 << " " << unified[1].size() - 1 << endl;
+
+
+    cout << "Rational test: a quarter of the unit circle; must print radius 1 at 0.3 and at every parameter" << endl
+         << "of the batch, then (0.71, 0.71, 0) for the middle of the arc, of its [0.25, 0.75] part and of the" << endl
+         << "arc through both halves of a split..." << endl;
+    auto arc = Bezier::RationalPolygonSoA<3, float>::fromPoints(
+        vector<Vector3D> { Vector3D(1, 0, 0), Vector3D(1, 1, 0), Vector3D(0, 1, 0) }, { 1, sqrt(0.5f), 1 });
+    auto radius = [] (const array<float, 3> &p) { return round(sqrt(p[0] * p[0] + p[1] * p[1]) * 1000) / 1000; };
+    cout << radius(Bezier::deCasteljau(arc, 0.3)) << endl;
+    vector<array<float, 3>> arcPoints;
+    Bezier::deCasteljau(arc, params.begin(), params.end(), back_inserter(arcPoints));
+    for (const array<float, 3> &p : arcPoints)
+        cout << radius(p) << " ";
+    cout << endl;
+    auto roundedPoint = [] (const array<float, 3> &p) {
+        return array<float, 3> { round(p[0] * 100) / 100, round(p[1] * 100) / 100, round(p[2] * 100) / 100 };
+    };
+    auto arcHalves = Bezier::split(arc, 0.5);
+    cout << roundedPoint(Bezier::deCasteljau(arc, 0.5)) << " "
+         << roundedPoint(Bezier::deCasteljau(Bezier::subdivide(arc, 0.25, 0.75), 0.5)) << " "
+         << roundedPoint(Bezier::deCasteljau(arcHalves.first, 1)) << " "
+         << roundedPoint(Bezier::deCasteljau(arcHalves.second, 0)) << endl;
+
+
+    cout << "Patch test: the patch (u, v, u * v); must print (0.5, 0.25, 0.125), then its grid at u, v in" << endl
+         << "{0, 0.5, 1}, twice (the second time from the batch, for the second of two patches)..." << endl;
+    Bezier::BezierPatch<Vector3D> patch(1, 1, { Vector3D(0, 0, 0), Vector3D(1, 0, 0),
+                                                Vector3D(0, 1, 0), Vector3D(1, 1, 1) });
+    Bezier::BezierPatchWorkspace<Vector3D> patchWorkspace;
+    cout << Bezier::deCasteljau(patch, 0.5, 0.25, patchWorkspace) << endl;
+    vector<Vector3D> grid;
+    Bezier::tessellateGrid(patch, 2, 2, back_inserter(grid), patchWorkspace);
+    for (const Vector3D &p : grid)
+        cout << p << " ";
+    cout << endl;
+    vector<Bezier::BezierPatch<Vector3D>> patches(2, patch);
+    vector<Vector3D> grids(2 * 9, Vector3D(0, 0, 0));
+    Bezier::tessellateGridBatch(pool, patches, 2, 2, grids.begin(), 1);
+    for (int idx = 9; idx < 18; ++idx)
+        cout << grids[idx] << " ";
+    cout << endl;
+
+    cout << "Patch allocation test: a 16x16 grid of a bicubic patch through a reserved workspace; the" << endl
+         << "number of points, then the scratch allocations while reserving and while tessellating; with" << endl
+         << "CAGD_BEZIER_INSTRUMENTATION, must print 289 2 0; without it, 289 0 0..." << endl;
+    vector<Vector3D> bicubicPoints;
+    for (int row = 0; row < 4; ++row)
+        for (int col = 0; col < 4; ++col)
+            bicubicPoints.push_back(Vector3D(col, row, (col - 1.5f) * (row - 1.5f)));
+    Bezier::BezierPatch<Vector3D> bicubic(3, 3, bicubicPoints);
+    Bezier::BezierPatchWorkspace<Vector3D> bicubicWorkspace;
+    vector<Vector3D> bicubicGrid(17 * 17, Vector3D(0, 0, 0));
+    Bezier::resetInstrumentationStats();
+    bicubicWorkspace.reserve(bicubic);
+    std::uint64_t reserveAllocations = Bezier::instrumentationStats().allocations;
+    Bezier::resetInstrumentationStats();
+    auto bicubicEnd = Bezier::tessellateGrid(bicubic, 16, 16, bicubicGrid.begin(), bicubicWorkspace);
+    std::uint64_t gridAllocations = Bezier::instrumentationStats().allocations;
+    assert( gridAllocations == 0 );
+    cout << (bicubicEnd - bicubicGrid.begin()) << " " << reserveAllocations << " " << gridAllocations << endl;
+
+    cout << "Segment count test: Wang's bound for a line, the curve at 0.01 and the curve clamped to 8" << endl
+         << "segments; must print 1 11 8..." << endl;
+    auto straightSoA = Bezier::ControlPolygonSoA<3>::fromPoints(straight);
+    cout << Bezier::uniformSegmentCount(straightSoA.view(), 0.01f, 64) << " "
+         << Bezier::uniformSegmentCount(soa.view(), 0.01f, 64) << " "
+         << Bezier::uniformSegmentCount(soa.view(), 0.01f, 8) << endl;
+
+    cout << "Tessellation cache test: a line and a curve queued at level 2, then nothing; their vertex" << endl
+         << "counts once published; the curve stale after a change; and redone; and, for a curve removed while" << endl
+         << "its work was queued and then set again, no polyline from that work; must print" << endl
+         << "2 0 / 2 7 1 / 0 7 / 1 2 / 1..." << endl;
+    Bezier::TessellationCache<3> lods(pool, 0.01f, 4);
+    lods.addCurve(straightSoA);
+    lods.addCurve(soa);
+    cout << lods.request(0.05f) << " " << lods.request(0.05f) << endl;
+    lods.wait();
+    cout << lods.polyline(0, 0.05f)->vertices.size() << " " << lods.polyline(1, 0.05f)->vertices.size() << " "
+         << lods.isCurrent(1, 0.05f) << endl;
+    lods.setCurve(1, straightSoA);
+    cout << lods.isCurrent(1, 0.05f) << " " << lods.polyline(1, 0.05f)->vertices.size() << endl;
+    cout << lods.request(0.05f) << " ";
+    lods.wait();
+    cout << lods.polyline(1, 0.05f)->vertices.size() << endl;
+    {
+        // The only worker is held until the curve has been removed.
+        Concurrency::WorkStealingPool held(2);
+        std::atomic<int> holdState { 0 };
+        held.submit([&holdState] {
+            holdState = 1;
+            while (holdState == 1)
+                std::this_thread::yield();
+        });
+        while (holdState == 0)
+            std::this_thread::yield();
+
+        Bezier::TessellationCache<3> removed(held, 0.01f, 4);
+        removed.addCurve(soa);
+        removed.request(0.01f);
+        removed.removeCurve(0);
+        holdState = 2;
+        removed.wait();
+        removed.setCurve(0, soa);
+        cout << (removed.polyline(0, 0.01f) == nullptr) << endl;
+    }
+
+    cout << "SPSC queue test: the capacity of a queue of 3, which pushes then fail; the pops in order; and" << endl
+         << "the sum of 100000 values passed between two threads, in order; must print 4 1 1 1 1 0 /" << endl
+         << "0 1 2 3 0 / 4999950000 1..." << endl;
+    Concurrency::SpscQueue<long> spsc(3);
+    cout << spsc.capacity();
+    for (long value = 0; value < 5; ++value)
+        cout << " " << spsc.tryPush(long(value));
+    cout << endl;
+    long popped = 0;
+    for (int idx = 0; idx < 4 && spsc.tryPop(popped); ++idx)
+        cout << popped << " ";
+    cout << spsc.tryPop(popped) << endl;
+    {
+        constexpr long NumValues = 100000;
+        std::thread producer([&spsc] {
+            for (long value = 0; value < NumValues; ++value)
+                while (!spsc.tryPush(long(value)))
+                    std::this_thread::yield();
+        });
+        long sum = 0;
+        bool ordered = true;
+        for (long expected = 0; expected < NumValues; ++expected)
+        {
+            while (!spsc.tryPop(popped))
+                std::this_thread::yield();
+            ordered &= popped == expected;
+            sum += popped;
+        }
+        producer.join();
+        cout << sum << " " << ordered << endl;
+    }
+
+    cout << "Coalescing pipeline test: 1000 edits of one key and one of another, doubled on the pool;" << endl
+         << "the last results, and whether the first key's results only went forward; must print 2000 14 1..." << endl;
+    {
+        Concurrency::CoalescingPipeline<int, int, int> pipeline(pool, [](const int &, const int &value) {
+            return 2 * value;
+        });
+        for (int value = 1; value <= 1000; ++value)
+            pipeline.submit(1, value);
+        pipeline.submit(2, 7);
+
+        int last[3] = { 0, 0, 0 };
+        bool forward = true;
+        while (pipeline.isPending(1) || pipeline.isPending(2))
+        {
+            pipeline.poll([&](int key, int output) {
+                forward &= output > last[key];
+                last[key] = output;
+            });
+            std::this_thread::yield();
+        }
+        cout << last[1] << " " << last[2] << " " << forward << endl;
+    }
+
+    cout << "Coalescing pipeline test: 64 keys through a queue of 4, polling only when the ready callback" << endl
+         << "says so; must print 64..." << endl;
+    {
+        Concurrency::CoalescingPipeline<int, int, int> pipeline(pool, [](const int &key, const int &) {
+            return key;
+        }, 4);
+        std::mutex readyMutex;
+        std::condition_variable readyChanged;
+        bool ready = false;
+        pipeline.setReadyCallback([&] {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            ready = true;
+            readyChanged.notify_one();
+        });
+
+        for (int key = 0; key < 64; ++key)
+            pipeline.submit(key, 0);
+
+        int numConsumed = 0;
+        while (numConsumed < 64)
+        {
+            {
+                std::unique_lock<std::mutex> lock(readyMutex);
+                readyChanged.wait(lock, [&] { return ready; });
+                ready = false;
+            }
+            numConsumed += pipeline.poll([](int, int) {});
+        }
+        cout << numConsumed << endl;
+    }
+
 
     return 0;
 }